@@ -728,6 +728,32 @@ static int bnxt_push_xmit_p5(struct bnxt *bp, struct bnxt_tx_ring_info *txr,
 	return 0;
 }
 
+/* Pushing a packet through the doorbell BAR saves the DMA read of the BD
+ * and data, but costs CPU time on the MMIO copy and is only allowed on an
+ * idle ring.  It pays off for sparse, latency sensitive traffic.  A push
+ * candidate that finds the ring busy, or that is part of an xmit_more
+ * burst, means the queue is under load; skip push for the next
+ * BNXT_TX_PUSH_BACKOFF candidates so that a streaming queue does not keep
+ * paying for the copy whenever the ring briefly drains.
+ */
+static bool bnxt_tx_push_ok(struct bnxt *bp, struct bnxt_tx_ring_info *txr,
+			    u32 free_size)
+{
+	struct bnxt_tx_sw_push_stats *stats = &txr->bnapi->cp_ring.sw_stats->tx;
+
+	if (free_size != bp->tx_ring_size || netdev_xmit_more()) {
+		txr->tx_push_backoff = BNXT_TX_PUSH_BACKOFF;
+		stats->tx_push_miss++;
+		return false;
+	}
+	if (txr->tx_push_backoff) {
+		txr->tx_push_backoff--;
+		stats->tx_push_backoff++;
+		return false;
+	}
+	return true;
+}
+
 void bnxt_txr_db_kick(struct bnxt *bp, struct bnxt_tx_ring_info *txr,
 		      u16 prod)
 {
@@ -737,14 +763,61 @@ void bnxt_txr_db_kick(struct bnxt *bp, struct bnxt_tx_ring_info *txr,
 	txr->kick_pending = 0;
 }
 
+/* A packet queued with xmit_more skips its TX completion and is reclaimed,
+ * in the same pass, by the completion of a later packet.  Only packets
+ * that do not ring the doorbell are eligible.  Bound the run that one
+ * completion covers: no more than tx_cmpl_max_bds BDs, which DIM lowers
+ * for latency sensitive rings, and no more than half the BQL limit in
+ * bytes so that BQL keeps seeing completions.  Below the wake threshold
+ * every packet asks for a completion.
+ */
+static bool bnxt_tx_skip_cmpl(struct bnxt *bp, struct bnxt_tx_ring_info *txr,
+			      struct netdev_queue *txq, u32 free_size,
+			      u16 bds, u32 bytes)
+{
+	struct bnxt_tx_sw_stats *stats = &txr->bnapi->cp_ring.sw_stats->tx_sw;
+
+	if (free_size < bp->tx_wake_thresh)
+		goto req_cmpl;
+
+	if (txr->tx_cmpl_bds + bds > READ_ONCE(txr->tx_cmpl_max_bds))
+		goto force_cmpl;
+#ifdef CONFIG_BQL
+	if (txr->tx_cmpl_bytes + bytes > READ_ONCE(txq->dql.limit) / 2)
+		goto force_cmpl;
+#endif
+	txr->tx_cmpl_bds += bds;
+	txr->tx_cmpl_bytes += bytes;
+	stats->tx_no_cmpl++;
+	return true;
+
+force_cmpl:
+	stats->tx_no_cmpl_limit++;
+req_cmpl:
+	txr->tx_cmpl_bds = 0;
+	txr->tx_cmpl_bytes = 0;
+	stats->tx_cmpl_req++;
+	return false;
+}
+
+/* An EDT ring only uses a timed BD for skbs stamped by fq or TCP with a
+ * CLOCK_MONOTONIC departure time.
+ */
+static bool bnxt_tx_edt_skb(struct bnxt_tx_ring_info *txr,
+			    struct sk_buff *skb)
+{
+	return txr->edt_enabled && ktime_to_ns(skb->tstamp) &&
+	       bnxt_skb_tstamp_mono(skb);
+}
+
 #if defined(HAVE_ETF_QOPT_OFFLOAD)
 static void bnxt_generate_txtimed_bd(struct bnxt *bp, struct sk_buff *skb,
 				     struct bnxt_tx_ring_info *txr,
-				     struct bnxt_sw_tx_bd *tx_buf, u16 *prod)
+				     struct bnxt_sw_tx_bd *tx_buf, u16 *prod,
+				     s64 txtime_ns)
 {
 	struct tx_bd_sotxtime *tx_bd_txtime;
 	u32 sotxtm_flags;
-	s64 txtime_ns;
 
 	*prod = NEXT_TX(*prod);
 
@@ -752,14 +825,38 @@ static void bnxt_generate_txtimed_bd(struct bnxt *bp, struct sk_buff *skb,
 	 * Expect application to adjtimex CLOCK_TAI offset,
 	 * so that skb->tstamp and phc is in same clock domain units.
 	 */
-	txtime_ns = ktime_to_ns(skb->tstamp);
 	tx_bd_txtime = (struct tx_bd_sotxtime *)
 		&txr->tx_desc_ring[TX_RING(bp, *prod)][TX_IDX(*prod)];
 	sotxtm_flags = TX_BD_FLAGS_KIND_SO_TXTIME | TX_BD_TYPE_TIMEDTX_BD;
 	tx_bd_txtime->tx_bd_len_flags_type = cpu_to_le32(sotxtm_flags);
 	/* Currently the driver supports RTC clock only */
 	tx_bd_txtime->tx_time = cpu_to_le64(txtime_ns);
+	tx_buf->is_txtime = 1;
 	skb_txtime_consumed(skb);
+	txr->bnapi->cp_ring.sw_stats->txtime.txtime_xmit++;
+}
+
+/* EDT timestamps set by the fq qdisc or TCP are CLOCK_MONOTONIC.  Move the
+ * departure time onto CLOCK_TAI, which the PHC in RTC mode is expected to
+ * follow, and let the hardware hold the packet.  A departure time that has
+ * already passed needs no timed BD, and one beyond the horizon is sent
+ * right away rather than tie up the ring.
+ */
+static void bnxt_generate_edt_bd(struct bnxt *bp, struct sk_buff *skb,
+				 struct bnxt_tx_ring_info *txr,
+				 struct bnxt_sw_tx_bd *tx_buf, u16 *prod)
+{
+	s64 delta = ktime_to_ns(ktime_sub(skb->tstamp, ktime_get()));
+
+	if (delta <= 0)
+		return;
+	if (delta > BNXT_TX_EDT_HORIZON_NS) {
+		txr->bnapi->cp_ring.sw_stats->txtime.txtime_edt_fallback++;
+		return;
+	}
+	bnxt_generate_txtimed_bd(bp, skb, txr, tx_buf, prod,
+				 ktime_to_ns(ktime_mono_to_any(skb->tstamp,
+							       TK_OFFS_TAI)));
 }
 #endif
 
@@ -775,8 +872,9 @@ netdev_tx_t __bnxt_start_xmit(struct bnxt *bp, struct netdev_queue *txq,
 	struct bnxt_sw_tx_bd *tx_buf;
 	u16 prod, last_frag, prod0;
 	struct tx_bd_ext *txbd1;
+	bool no_cmpl = false;
 	dma_addr_t mapping;
-	int i;
+	int i, bd_cnt;
 
 	prod = txr->tx_prod;
 	if (unlikely(ipv6_hopopt_jumbo_remove(skb)))
@@ -791,6 +889,7 @@ netdev_tx_t __bnxt_start_xmit(struct bnxt *bp, struct netdev_queue *txq,
 	tx_buf = &txr->tx_buf_ring[RING_TX(bp, prod)];
 	tx_buf->skb = skb;
 	tx_buf->nr_frags = last_frag;
+	tx_buf->is_txtime = 0;
 
 	vlan_tag_flags = 0;
 	cfa_action = bnxt_xmit_get_cfa_action(bp, skb);
@@ -841,8 +940,10 @@ netdev_tx_t __bnxt_start_xmit(struct bnxt *bp, struct netdev_queue *txq,
 #endif
 
 	free_size = bnxt_tx_avail(bp, txr);
-	if (free_size == bp->tx_ring_size && length <= bp->tx_push_thresh &&
-	    !lflags && !txr->etf_enabled) {
+	if (bp->tx_push_mode != BNXT_PUSH_MODE_NONE &&
+	    length <= bp->tx_push_thresh && !lflags && !txr->etf_enabled &&
+	    !bnxt_tx_edt_skb(txr, skb) &&
+	    bnxt_tx_push_ok(bp, txr, free_size)) {
 		switch (bp->tx_push_mode) {
 		case BNXT_PUSH_MODE_WCB:
 			fallthrough;
@@ -860,6 +961,7 @@ netdev_tx_t __bnxt_start_xmit(struct bnxt *bp, struct netdev_queue *txq,
 			break;
 		}
 		/* Continue normal TX if push fails. */
+		txr->bnapi->cp_ring.sw_stats->tx.tx_push_miss++;
 	}
 
 	if (length < BNXT_MIN_PKT_SIZE) {
@@ -933,11 +1035,15 @@ netdev_tx_t __bnxt_start_xmit(struct bnxt *bp, struct netdev_queue *txq,
 
 #if defined(HAVE_ETF_QOPT_OFFLOAD)
 	if (txr->etf_enabled)
-		bnxt_generate_txtimed_bd(bp, skb, txr, tx_buf, &prod);
+		bnxt_generate_txtimed_bd(bp, skb, txr, tx_buf, &prod,
+					 ktime_to_ns(skb->tstamp));
+	else if (bnxt_tx_edt_skb(txr, skb))
+		bnxt_generate_edt_bd(bp, skb, txr, tx_buf, &prod);
 #endif
+	bd_cnt = BNXT_TX_BD_LONG_CNT + tx_buf->is_txtime + last_frag;
 	flags |= (len << TX_BD_LEN_SHIFT) | TX_BD_TYPE_LONG_TX_BD |
-		((last_frag + txr->bd_base_cnt) << TX_BD_FLAGS_BD_CNT_SHIFT);
-	txbd->tx_bd_opaque = SET_TX_OPAQUE(bp, txr, prod0, txr->bd_base_cnt + last_frag);
+		 (bd_cnt << TX_BD_FLAGS_BD_CNT_SHIFT);
+	txbd->tx_bd_opaque = SET_TX_OPAQUE(bp, txr, prod0, bd_cnt);
 	txbd->tx_bd_len_flags_type = cpu_to_le32(flags);
 	txbd1->tx_bd_cfa_meta = cpu_to_le32(vlan_tag_flags);
 	txbd1->tx_bd_cfa_action =
@@ -984,8 +1090,13 @@ netdev_tx_t __bnxt_start_xmit(struct bnxt *bp, struct netdev_queue *txq,
 	if (!netdev_xmit_more() || netif_xmit_stopped(txq)) {
 		mmiowb();
 		bnxt_txr_db_kick(bp, txr, prod);
+		txr->tx_cmpl_bds = 0;
+		txr->tx_cmpl_bytes = 0;
+		txr->bnapi->cp_ring.sw_stats->tx_sw.tx_cmpl_req++;
 	} else {
-		if (free_size >= bp->tx_wake_thresh)
+		no_cmpl = bnxt_tx_skip_cmpl(bp, txr, txq, free_size,
+					    (u16)(prod - prod0), skb->len);
+		if (no_cmpl)
 			txbd0->tx_bd_len_flags_type |=
 				cpu_to_le32(TX_BD_FLAGS_NO_CMPL);
 		txr->kick_pending = 1;
@@ -994,19 +1105,24 @@ netdev_tx_t __bnxt_start_xmit(struct bnxt *bp, struct netdev_queue *txq,
 tx_done:
 	if (unlikely(bnxt_tx_avail(bp, txr) < MAX_SKB_FRAGS + txr->bd_base_cnt)) {
 		if (netdev_xmit_more() && !tx_buf->is_push) {
-			if (txbd0) {
+			if (no_cmpl) {
+				struct bnxt_tx_sw_stats *stats;
+
 				txbd0->tx_bd_len_flags_type &=
 					cpu_to_le32(~TX_BD_FLAGS_NO_CMPL);
 				mmiowb();
+				stats = &txr->bnapi->cp_ring.sw_stats->tx_sw;
+				stats->tx_no_cmpl--;
+				stats->tx_no_cmpl_limit++;
+				stats->tx_cmpl_req++;
+				txr->tx_cmpl_bds = 0;
+				txr->tx_cmpl_bytes = 0;
 			}
 			bnxt_txr_db_kick(bp, txr, prod);
 		}
 		netif_txq_try_stop(txq, bnxt_tx_avail(bp, txr),
 				   bp->tx_wake_thresh);
 	}
-	if (txr->etf_enabled)
-		txr->bnapi->cp_ring.sw_stats->txtime.txtime_xmit++;
-
 	return NETDEV_TX_OK;
 
 tx_dma_error:
@@ -1021,6 +1137,8 @@ tx_dma_error:
 	dma_unmap_single(&pdev->dev, dma_unmap_addr(tx_buf, mapping),
 			 skb_headlen(skb), DMA_TO_DEVICE);
 	prod = NEXT_TX(prod);
+	if (tx_buf->is_txtime)
+		prod = NEXT_TX(prod);
 
 	/* unmap remaining mapped pages */
 	for (i = 0; i < last_frag; i++) {
@@ -1080,10 +1198,15 @@ static netdev_tx_t bnxt_start_xmit(struct sk_buff *skb, struct net_device *dev)
 	return __bnxt_start_xmit(bp, txq, txr, skb, lflags, kid);
 }
 
-/* Returns true if some remaining TX packets not processed. */
-static bool __bnxt_tx_int(struct bnxt *bp, struct bnxt_tx_ring_info *txr)
+/* Returns true if some remaining TX packets not processed.  Completed skbs
+ * are released through napi_consume_skb() so that a NAPI poll frees them in
+ * bulk from the per-CPU skb cache; budget is 0 from netpoll.
+ */
+static bool __bnxt_tx_int(struct bnxt *bp, struct bnxt_tx_ring_info *txr,
+			  int budget)
 {
 	struct netdev_queue *txq = netdev_get_tx_queue(bp->dev, txr->txq_index);
+	struct bnxt_tx_sw_stats *stats = &txr->bnapi->cp_ring.sw_stats->tx_sw;
 	struct pci_dev *pdev = bp->pdev;
 	u16 hw_cons = txr->tx_hw_cons;
 	unsigned int tx_bytes = 0;
@@ -1126,7 +1249,7 @@ static bool __bnxt_tx_int(struct bnxt *bp, struct bnxt_tx_ring_info *txr)
 			return rc;
 		}
 
-		if (txr->etf_enabled)
+		if (tx_buf->is_txtime)
 			cons = NEXT_TX(cons);
 
 		tx_bytes += skb->len;
@@ -1157,9 +1280,13 @@ next_tx_int:
 		cons = NEXT_TX(cons);
 
 		tx_pkts++;
-		dev_consume_skb_any(skb);
+		napi_consume_skb(skb, budget);
 	}
 
+	stats->tx_reclaim_polls++;
+	stats->tx_reclaim_bds += (u16)(cons - txr->tx_cons);
+	txr->bnapi->cp_ring.tx_packets += tx_pkts;
+	txr->bnapi->cp_ring.tx_bytes += tx_bytes;
 	WRITE_ONCE(txr->tx_cons, cons);
 
 	__netif_txq_completed_wake(txq, tx_pkts, tx_bytes,
@@ -1176,7 +1303,7 @@ static void bnxt_tx_int(struct bnxt *bp, struct bnxt_napi *bnapi, int budget)
 
 	bnxt_for_each_napi_tx(i, bnapi, txr) {
 		if (txr->tx_hw_cons != RING_TX(bp, txr->tx_cons))
-			more |= __bnxt_tx_int(bp, txr);
+			more |= __bnxt_tx_int(bp, txr, budget);
 	}
 	if (!more)
 		bnapi->events &= ~BNXT_TX_CMP_EVENT;
@@ -1262,12 +1389,61 @@ static struct page *__bnxt_alloc_rx_page(struct bnxt *bp, dma_addr_t *mapping,
 }
 #endif
 
+#ifdef HAVE_BNXT_RX_NETMEM
+/* Aggregation buffers may come from a memory provider bound to the queue
+ * (devmem dma-buf or io_uring zero copy receive), so they are handled as
+ * netmem and never touched by the CPU here.
+ */
+static netmem_ref __bnxt_alloc_rx_netmem(struct bnxt *bp, dma_addr_t *mapping,
+					 struct bnxt_rx_ring_info *rxr,
+					 unsigned int *offset, gfp_t gfp)
+{
+	netmem_ref netmem;
+
+	gfp |= __GFP_NOWARN;
+	if (PAGE_SIZE > BNXT_RX_PAGE_SIZE) {
+		netmem = page_pool_alloc_frag_netmem(rxr->page_pool, offset,
+						     BNXT_RX_PAGE_SIZE, gfp);
+	} else {
+		netmem = page_pool_alloc_netmems(rxr->page_pool, gfp);
+		*offset = 0;
+	}
+	if (!netmem)
+		return 0;
+
+	*mapping = page_pool_get_dma_addr_netmem(netmem) + *offset;
+	return netmem;
+}
+#endif
+
+#ifdef HAVE_BNXT_RX_HEAD_POOL
+static bool bnxt_rx_head_pool_en(struct bnxt *bp)
+{
+	return !BNXT_RX_PAGE_MODE(bp) && bp->rx_buf_size <= PAGE_SIZE / 2;
+}
+#endif
+
 static inline u8 *__bnxt_alloc_rx_frag(struct bnxt *bp, dma_addr_t *mapping,
-				       gfp_t gfp)
+				       struct bnxt_rx_ring_info *rxr, gfp_t gfp)
 {
 	u8 *data;
 	struct pci_dev *pdev = bp->pdev;
 
+#ifdef HAVE_BNXT_RX_HEAD_POOL
+	if (rxr->head_pool) {
+		unsigned int offset;
+		struct page *page;
+
+		page = page_pool_alloc_frag(rxr->head_pool, &offset,
+					    bp->rx_buf_size, gfp);
+		if (!page)
+			return NULL;
+
+		*mapping = page_pool_get_dma_addr(page) + offset +
+			   bp->rx_dma_offset;
+		return page_address(page) + offset;
+	}
+#endif
 	if (gfp == GFP_ATOMIC)
 		data = napi_alloc_frag(bp->rx_buf_size);
 	else
@@ -1285,6 +1461,40 @@ static inline u8 *__bnxt_alloc_rx_frag(struct bnxt *bp, dma_addr_t *mapping,
 	}
 	return data;
 }
+
+/* Free a head buffer from __bnxt_alloc_rx_frag() that no skb owns. */
+static void __bnxt_free_rx_frag(struct bnxt *bp, struct bnxt_rx_ring_info *rxr,
+				u8 *data, dma_addr_t mapping)
+{
+#ifdef HAVE_BNXT_RX_HEAD_POOL
+	if (rxr->head_pool) {
+		page_pool_recycle_direct(rxr->head_pool,
+					 virt_to_head_page(data));
+		return;
+	}
+#endif
+	dma_unmap_single_attrs(&bp->pdev->dev, mapping, bp->rx_buf_use_size,
+			       bp->rx_dir, DMA_ATTR_WEAK_ORDERING);
+	skb_free_frag(data);
+}
+
+/* Hand a head buffer over to the skb built on top of it.  Page pool
+ * fragments stay mapped and go back to the pool when the skb is freed.
+ */
+static void bnxt_rx_frag_to_skb(struct bnxt *bp, struct bnxt_rx_ring_info *rxr,
+				struct sk_buff *skb, dma_addr_t mapping)
+{
+#ifdef HAVE_BNXT_RX_HEAD_POOL
+	if (rxr->head_pool) {
+		dma_sync_single_for_cpu(&bp->pdev->dev, mapping,
+					bp->rx_buf_use_size, bp->rx_dir);
+		skb_mark_for_recycle(skb);
+		return;
+	}
+#endif
+	dma_unmap_single_attrs(&bp->pdev->dev, mapping, bp->rx_buf_use_size,
+			       bp->rx_dir, DMA_ATTR_WEAK_ORDERING);
+}
 #else
 
 static struct page *__bnxt_alloc_rx_page(struct bnxt *bp, dma_addr_t *mapping,
@@ -1296,6 +1506,7 @@ static struct page *__bnxt_alloc_rx_page(struct bnxt *bp, dma_addr_t *mapping,
 
 static inline struct sk_buff *__bnxt_alloc_rx_frag(struct bnxt *bp,
 						   dma_addr_t *mapping,
+						   struct bnxt_rx_ring_info *rxr,
 						   gfp_t gfp)
 {
 	struct sk_buff *skb;
@@ -1354,9 +1565,10 @@ int bnxt_alloc_rx_data(struct bnxt *bp, struct bnxt_rx_ring_info *rxr,
 		rx_buf->data_ptr = page_address(page) + offset + bp->rx_offset;
 	} else {
 #ifdef HAVE_BUILD_SKB
-		u8 *data = __bnxt_alloc_rx_frag(bp, &mapping, gfp);
+		u8 *data = __bnxt_alloc_rx_frag(bp, &mapping, rxr, gfp);
 #else
-		struct sk_buff *data = __bnxt_alloc_rx_frag(bp, &mapping, gfp);
+		struct sk_buff *data = __bnxt_alloc_rx_frag(bp, &mapping, rxr,
+							    gfp);
 #endif
 
 		if (!data)
@@ -1413,15 +1625,41 @@ static inline int bnxt_alloc_rx_page(struct bnxt *bp,
 	struct rx_bd *rxbd =
 		&rxr->rx_agg_desc_ring[RX_AGG_RING(bp, prod)][RX_IDX(prod)];
 	struct bnxt_sw_rx_agg_bd *rx_agg_buf;
-	struct page *page;
+#ifdef HAVE_BNXT_RX_NETMEM
+	netmem_ref netmem = 0;
+#else
+	struct page *page = NULL;
+#endif
+#ifdef HAVE_XSK_MULTI_BUFF
+	struct xdp_buff *xsk_buf = NULL;
+#endif
 	dma_addr_t mapping;
 	u16 sw_prod = rxr->rx_sw_agg_prod;
 	unsigned int offset = 0;
 
+#ifdef HAVE_XSK_MULTI_BUFF
+	if (BNXT_RING_RX_ZC_MODE(rxr) && rxr->xsk_pool) {
+		xsk_buf = xsk_buff_alloc(rxr->xsk_pool);
+		if (!xsk_buf)
+			return -ENOMEM;
+		mapping = xsk_buff_xdp_get_dma(xsk_buf);
+		goto set_agg_buf;
+	}
+#endif
+#ifdef HAVE_BNXT_RX_NETMEM
+	netmem = __bnxt_alloc_rx_netmem(bp, &mapping, rxr, &offset, gfp);
+	if (!netmem)
+		return -ENOMEM;
+#else
 	page = __bnxt_alloc_rx_page(bp, &mapping, rxr, &offset, gfp);
 
 	if (!page)
 		return -ENOMEM;
+#endif
+
+#ifdef HAVE_XSK_MULTI_BUFF
+set_agg_buf:
+#endif
 
 	if (unlikely(test_bit(sw_prod, rxr->rx_agg_bmap)))
 		sw_prod = bnxt_find_next_agg_idx(rxr, sw_prod);
@@ -1430,7 +1668,15 @@ static inline int bnxt_alloc_rx_page(struct bnxt *bp,
 	rx_agg_buf = &rxr->rx_agg_ring[sw_prod];
 	rxr->rx_sw_agg_prod = RING_RX_AGG(bp, NEXT_RX_AGG(sw_prod));
 
+#ifdef HAVE_BNXT_RX_NETMEM
+	rx_agg_buf->netmem = netmem;
+#else
 	rx_agg_buf->page = page;
+#endif
+#ifdef HAVE_XSK_MULTI_BUFF
+	if (xsk_buf)
+		rx_agg_buf->xsk_buf = xsk_buf;
+#endif
 	rx_agg_buf->offset = offset;
 	rx_agg_buf->mapping = mapping;
 	rxbd->rx_bd_haddr = cpu_to_le64(mapping);
@@ -1639,12 +1885,11 @@ static struct sk_buff *bnxt_rx_skb(struct bnxt *bp,
 	}
 
 	skb = napi_build_skb(data, bp->rx_buf_size);
-	dma_unmap_single_attrs(&bp->pdev->dev, dma_addr, bp->rx_buf_use_size,
-			       bp->rx_dir, DMA_ATTR_WEAK_ORDERING);
 	if (!skb) {
-		skb_free_frag(data);
+		__bnxt_free_rx_frag(bp, rxr, data, dma_addr);
 		return NULL;
 	}
+	bnxt_rx_frag_to_skb(bp, rxr, skb, dma_addr);
 
 	skb_reserve(skb, bp->rx_offset);
 	skb_put(skb, offset_and_len & 0xffff);
@@ -1682,7 +1927,7 @@ static u32 __bnxt_rx_agg_pages(struct bnxt *bp,
 			       struct xdp_buff *xdp)
 {
 	struct bnxt_napi *bnapi = cpr->bnapi;
-	struct pci_dev *pdev = bp->pdev;
+	struct pci_dev __maybe_unused *pdev = bp->pdev;
 	struct bnxt_rx_ring_info *rxr = bnapi->rx_ring;
 	u16 prod = rxr->rx_agg_prod;
 	u32 i, total_frag_len = 0;
@@ -1696,8 +1941,12 @@ static u32 __bnxt_rx_agg_pages(struct bnxt *bp,
 		u16 cons, frag_len;
 		struct rx_agg_cmp *agg;
 		struct bnxt_sw_rx_agg_bd *cons_rx_buf;
+#ifdef HAVE_BNXT_RX_NETMEM
+		netmem_ref netmem;
+		u32 offset;
+#endif
 		struct page *page;
-		dma_addr_t mapping;
+		dma_addr_t __maybe_unused mapping;
 
 		if (p5_tpa)
 			agg = bnxt_get_tpa_agg_p5(bp, rxr, idx, i);
@@ -1708,8 +1957,14 @@ static u32 __bnxt_rx_agg_pages(struct bnxt *bp,
 			    RX_AGG_CMP_LEN) >> RX_AGG_CMP_LEN_SHIFT;
 
 		cons_rx_buf = &rxr->rx_agg_ring[cons];
+#ifdef HAVE_BNXT_RX_NETMEM
+		netmem = cons_rx_buf->netmem;
+		offset = cons_rx_buf->offset;
+		skb_frag_fill_netmem_desc(frag, netmem, offset, frag_len);
+#else
 		skb_frag_fill_page_desc(frag, cons_rx_buf->page,
 					cons_rx_buf->offset, frag_len);
+#endif
 		shinfo->nr_frags = i + 1;
 		__clear_bit(cons, rxr->rx_agg_bmap);
 
@@ -1738,6 +1993,10 @@ static u32 __bnxt_rx_agg_pages(struct bnxt *bp,
 #ifndef HAVE_PAGE_POOL_GET_DMA_ADDR
 		dma_unmap_page_attrs(&pdev->dev, mapping, BNXT_RX_PAGE_SIZE,
 				     bp->rx_dir, DMA_ATTR_WEAK_ORDERING);
+#elif defined(HAVE_BNXT_RX_NETMEM)
+		/* no-op for unreadable memory provider buffers */
+		page_pool_dma_sync_netmem_for_cpu(rxr->page_pool, netmem,
+						  offset, BNXT_RX_PAGE_SIZE);
 #else
 		dma_sync_single_for_cpu(&pdev->dev, mapping, BNXT_RX_PAGE_SIZE,
 					bp->rx_dir);
@@ -1796,6 +2055,10 @@ static struct sk_buff *bnxt_rx_agg_pages_skb(struct bnxt *bp,
 	skb->data_len += total_frag_len;
 	skb->len += total_frag_len;
 	skb->truesize += BNXT_RX_PAGE_SIZE * agg_bufs;
+#ifdef HAVE_BNXT_RX_NETMEM
+	if (netmem_is_net_iov(skb_frag_netmem(&shinfo->frags[0])))
+		skb->unreadable = true;
+#endif
 	return skb;
 }
 
@@ -1826,6 +2089,62 @@ static u32 bnxt_rx_agg_pages_xdp(struct bnxt *bp,
 	return total_frag_len;
 }
 
+#ifdef HAVE_XSK_MULTI_BUFF
+/* AF_XDP zero-copy counterpart of bnxt_rx_agg_pages_xdp().  The
+ * aggregation buffers come from the XSK pool and are chained to the head
+ * buffer as frags.  Returns 0 and recycles the remaining aggregation
+ * buffers if the ring cannot be refilled.
+ */
+static u32 bnxt_rx_agg_xsk(struct bnxt *bp, struct bnxt_cp_ring_info *cpr,
+			   struct xdp_buff *xdp, u16 idx, u32 agg_bufs)
+{
+	struct bnxt_rx_ring_info *rxr = cpr->bnapi->rx_ring;
+	u16 prod = rxr->rx_agg_prod;
+	u32 total_frag_len = 0;
+	u32 i;
+
+	for (i = 0; i < agg_bufs; i++) {
+		struct bnxt_sw_rx_agg_bd *cons_rx_buf;
+		struct rx_agg_cmp *agg;
+		struct xdp_buff *frag;
+		u16 cons, frag_len;
+
+		agg = bnxt_get_agg(bp, cpr, idx, i);
+		cons = agg->rx_agg_cmp_opaque;
+		frag_len = (le32_to_cpu(agg->rx_agg_cmp_len_flags_type) &
+			    RX_AGG_CMP_LEN) >> RX_AGG_CMP_LEN_SHIFT;
+
+		cons_rx_buf = &rxr->rx_agg_ring[cons];
+		frag = cons_rx_buf->xsk_buf;
+		__clear_bit(cons, rxr->rx_agg_bmap);
+		cons_rx_buf->xsk_buf = NULL;
+
+		if (bnxt_alloc_rx_page(bp, rxr, prod, GFP_ATOMIC)) {
+			cons_rx_buf->xsk_buf = frag;
+			rxr->rx_agg_prod = prod;
+			bnxt_reuse_rx_agg_bufs(cpr, idx, i, agg_bufs - i, false);
+			bnxt_xsk_free_frags(xdp);
+			return 0;
+		}
+		prod = NEXT_RX_AGG(prod);
+
+		xsk_buff_set_size(frag, frag_len);
+		xsk_buff_dma_sync_for_cpu(frag, rxr->xsk_pool);
+		if (!bnxt_xsk_add_frag(xdp, frag)) {
+			xsk_buff_free(frag);
+			rxr->rx_agg_prod = prod;
+			bnxt_reuse_rx_agg_bufs(cpr, idx, i + 1, agg_bufs - i - 1,
+					       false);
+			bnxt_xsk_free_frags(xdp);
+			return 0;
+		}
+		total_frag_len += frag_len;
+	}
+	rxr->rx_agg_prod = prod;
+	return total_frag_len;
+}
+#endif
+
 int bnxt_agg_bufs_valid(struct bnxt *bp, struct bnxt_cp_ring_info *cpr,
 			u8 agg_bufs, u32 *raw_cons)
 {
@@ -1845,20 +2164,21 @@ static inline struct sk_buff *bnxt_copy_data(struct bnxt_napi *bnapi, u8 *data,
 {
 	struct bnxt *bp = bnapi->bp;
 	struct pci_dev *pdev = bp->pdev;
+	unsigned int sync_len;
 	struct sk_buff *skb;
 
 	skb = napi_alloc_skb(&bnapi->napi, len);
 	if (!skb)
 		return NULL;
 
-	dma_sync_single_for_cpu(&pdev->dev, mapping, bp->rx_copy_thresh,
-				bp->rx_dir);
+	/* The per ring copybreak may be above the global threshold */
+	sync_len = max_t(unsigned int, bp->rx_copy_thresh, len + NET_IP_ALIGN);
+	dma_sync_single_for_cpu(&pdev->dev, mapping, sync_len, bp->rx_dir);
 
 	memcpy(skb->data - NET_IP_ALIGN, data - NET_IP_ALIGN,
 	       len + NET_IP_ALIGN);
 
-	dma_sync_single_for_device(&pdev->dev, mapping, bp->rx_copy_thresh,
-				   bp->rx_dir);
+	dma_sync_single_for_device(&pdev->dev, mapping, sync_len, bp->rx_dir);
 
 	skb_put(skb, len);
 
@@ -1908,6 +2228,74 @@ static inline struct sk_buff *bnxt_copy_xdp(struct bnxt_napi *bnapi,
 }
 #endif
 
+/* Count the packet in the ring's size histogram and, once every
+ * BNXT_RX_COPYBREAK_WIN packets, pick the ring's copybreak threshold.
+ * Copying avoids replacing the RX buffer and keeps the skb truesize small,
+ * but costs a memcpy that grows with the packet.  A ring whose traffic is
+ * almost all small (at least 15/16 of the window below some bin edge) gets
+ * its threshold raised to that edge, up to BNXT_RX_COPY_THRESH_MAX; any
+ * other ring uses the global threshold.  The threshold is never lowered
+ * below bp->rx_copy_thresh.  With aggregation rings the head buffer only
+ * holds bp->rx_copy_thresh bytes, so that is the limit.
+ * Only called while adaptive copybreak is enabled, which is off by default.
+ */
+static void bnxt_rx_copybreak_update(struct bnxt *bp,
+				     struct bnxt_rx_ring_info *rxr,
+				     unsigned int len)
+{
+	u32 bin = min_t(u32, fls((len - 1) >> 6), BNXT_RX_SIZE_HIST_BINS - 1);
+	u32 max_thresh, thresh, cum = 0;
+	int i;
+
+	rxr->rx_size_hist[bin]++;
+	rxr->rx_size_win[bin]++;
+	if (++rxr->rx_size_win_cnt < BNXT_RX_COPYBREAK_WIN)
+		return;
+
+	if (bp->flags & BNXT_FLAG_AGG_RINGS)
+		max_thresh = bp->rx_copy_thresh;
+	else
+		max_thresh = BNXT_RX_COPY_THRESH_MAX;
+
+	thresh = bp->rx_copy_thresh;
+	for (i = 0; i < BNXT_RX_SIZE_HIST_BINS - 1 &&
+		    BNXT_RX_SIZE_BIN_EDGE(i) <= max_thresh; i++) {
+		cum += rxr->rx_size_win[i];
+		if (cum >= BNXT_RX_COPYBREAK_WIN - BNXT_RX_COPYBREAK_WIN / 16) {
+			thresh = max(thresh, BNXT_RX_SIZE_BIN_EDGE(i));
+			break;
+		}
+	}
+	rxr->rx_copy_thresh = thresh;
+	rxr->rx_size_win_cnt = 0;
+	memset(rxr->rx_size_win, 0, sizeof(rxr->rx_size_win));
+}
+
+static void bnxt_rx_copybreak_reset(struct bnxt *bp,
+				    struct bnxt_rx_ring_info *rxr)
+{
+	rxr->rx_copy_thresh = bp->rx_copy_thresh;
+	rxr->rx_size_win_cnt = 0;
+	memset(rxr->rx_size_win, 0, sizeof(rxr->rx_size_win));
+}
+
+void bnxt_set_rx_copybreak_adapt(struct bnxt *bp, bool enable)
+{
+	int i;
+
+	if (bp->rx_copybreak_adapt == enable)
+		return;
+
+	WRITE_ONCE(bp->rx_copybreak_adapt, enable);
+	if (enable || !bp->rx_ring)
+		return;
+
+	/* Wait for NAPI polls that may still be adapting the thresholds */
+	synchronize_net();
+	for (i = 0; i < bp->rx_nr_rings; i++)
+		bnxt_rx_copybreak_reset(bp, &bp->rx_ring[i]);
+}
+
 static int bnxt_discard_rx(struct bnxt *bp, struct bnxt_cp_ring_info *cpr,
 			   u32 *raw_cons, void *cmp)
 {
@@ -2056,6 +2444,9 @@ static void bnxt_tpa_start(struct bnxt *bp, struct bnxt_rx_ring_info *rxr,
 		bnxt_sched_reset_rxr(bp, rxr);
 		return;
 	}
+	if (++rxr->tpa_inflight > rxr->tpa_inflight_max)
+		rxr->tpa_inflight_max = rxr->tpa_inflight;
+
 	prod_rx_buf->data = tpa_info->data;
 	prod_rx_buf->data_ptr = tpa_info->data_ptr;
 
@@ -2114,6 +2505,26 @@ static void bnxt_abort_tpa(struct bnxt_cp_ring_info *cpr, u16 idx, u32 agg_bufs)
 		bnxt_reuse_rx_agg_bufs(cpr, idx, 0, agg_bufs, true);
 }
 
+/* The TPA end completion does not carry an end reason.  An aggregation
+ * that reached the configured segment limit is counted as a max segs
+ * end, anything shorter was closed by the timer, a flush or an out of
+ * order segment.
+ */
+static void bnxt_tpa_account(struct bnxt *bp, struct bnxt_cp_ring_info *cpr,
+			     struct bnxt_rx_ring_info *rxr, u16 segs)
+{
+	struct bnxt_rx_sw_stats *sw_stats = &cpr->sw_stats->rx;
+
+	segs = max_t(u16, segs, 1);
+	sw_stats->rx_tpa_segs += segs;
+	if (segs >= bp->tpa_seg_limit)
+		sw_stats->rx_tpa_max_segs_end++;
+	else
+		sw_stats->rx_tpa_early_end++;
+	rxr->tpa_segs_hist[min_t(u32, ilog2(segs),
+				 BNXT_TPA_SEGS_HIST_BINS - 1)]++;
+}
+
 #ifdef CONFIG_INET
 static void bnxt_gro_tunnel(struct sk_buff *skb, __be16 ip_proto)
 {
@@ -2410,6 +2821,9 @@ static inline struct sk_buff *bnxt_tpa_end(struct bnxt *bp,
 		gro = !!TPA_END_GRO(tpa_end);
 		tpa_info->payload_off = TPA_END_PAYLOAD_OFF(tpa_end);
 	}
+	if (rxr->tpa_inflight)
+		rxr->tpa_inflight--;
+
 	data = tpa_info->data;
 	data_ptr = tpa_info->data_ptr;
 	prefetch(data_ptr);
@@ -2418,11 +2832,13 @@ static inline struct sk_buff *bnxt_tpa_end(struct bnxt *bp,
 
 	if (unlikely(agg_bufs > MAX_SKB_FRAGS || TPA_END_ERRORS(tpa_end1))) {
 		bnxt_abort_tpa(cpr, idx, agg_bufs);
+		cpr->sw_stats->rx.rx_tpa_sw_aborts += 1;
 		if (agg_bufs > MAX_SKB_FRAGS)
 			netdev_warn(bp->dev, "TPA frags %d exceeded MAX_SKB_FRAGS %d\n",
 				    agg_bufs, (int)MAX_SKB_FRAGS);
 		return NULL;
 	}
+	bnxt_tpa_account(bp, cpr, rxr, TPA_END_TPA_SEGS(tpa_end));
 
 	if (len <= bp->rx_copy_thresh) {
 		skb = bnxt_copy_skb(bnapi, data_ptr, len, mapping);
@@ -2439,7 +2855,8 @@ static inline struct sk_buff *bnxt_tpa_end(struct bnxt *bp,
 #endif
 		dma_addr_t new_mapping;
 
-		new_data = __bnxt_alloc_rx_frag(bp, &new_mapping, GFP_ATOMIC);
+		new_data = __bnxt_alloc_rx_frag(bp, &new_mapping, rxr,
+						GFP_ATOMIC);
 		if (!new_data) {
 			bnxt_abort_tpa(cpr, idx, agg_bufs);
 			cpr->sw_stats->rx.rx_oom_discards += 1;
@@ -2456,20 +2873,19 @@ static inline struct sk_buff *bnxt_tpa_end(struct bnxt *bp,
 
 #ifdef HAVE_BUILD_SKB
 		skb = napi_build_skb(data, bp->rx_buf_size);
-#else
-		skb = data;
-#endif
-		dma_unmap_single_attrs(&bp->pdev->dev, mapping,
-				       bp->rx_buf_use_size, bp->rx_dir,
-				       DMA_ATTR_WEAK_ORDERING);
-#ifdef HAVE_BUILD_SKB
 		if (!skb) {
-			skb_free_frag(data);
+			__bnxt_free_rx_frag(bp, rxr, data, mapping);
 			bnxt_abort_tpa(cpr, idx, agg_bufs);
 			cpr->sw_stats->rx.rx_oom_discards += 1;
 			return NULL;
 		}
+		bnxt_rx_frag_to_skb(bp, rxr, skb, mapping);
 		skb_reserve(skb, bp->rx_offset);
+#else
+		skb = data;
+		dma_unmap_single_attrs(&bp->pdev->dev, mapping,
+				       bp->rx_buf_use_size, bp->rx_dir,
+				       DMA_ATTR_WEAK_ORDERING);
 #endif
 		skb_put(skb, len);
 	}
@@ -2669,6 +3085,132 @@ static enum pkt_hash_types bnxt_rss_ext_op(struct bnxt *bp,
 	}
 }
 
+static enum pkt_hash_types bnxt_rx_hash_type(struct bnxt *bp, u8 cmp_type,
+					     struct rx_cmp *rxcmp)
+{
+	u32 hash_type;
+
+	if (cmp_type == CMP_TYPE_RX_L2_V3_CMP)
+		return bnxt_rss_ext_op(bp, rxcmp);
+
+	hash_type = RX_CMP_HASH_TYPE(rxcmp);
+	/* RSS profiles 1 and 3 with extract code 0 for inner 4-tuple */
+	if (hash_type != 1 && hash_type != 3)
+		return PKT_HASH_TYPE_L3;
+	return PKT_HASH_TYPE_L4;
+}
+
+#ifdef HAVE_XDP_METADATA_OPS
+static int bnxt_xdp_rx_hash(const struct xdp_md *ctx, u32 *hash,
+			    enum xdp_rss_hash_type *rss_type)
+{
+	const struct bnxt_xdp_buff *bxdp = (void *)ctx;
+	struct bnxt *bp = netdev_priv(bxdp->xdp.rxq->dev);
+	struct rx_cmp_ext *rxcmp1 = bxdp->rxcmp1;
+	struct rx_cmp *rxcmp = bxdp->rxcmp;
+	enum xdp_rss_hash_type type;
+	u32 itype;
+
+	if (!RX_CMP_HASH_VALID(rxcmp))
+		return -ENODATA;
+
+	*hash = le32_to_cpu(rxcmp->rx_cmp_rss_hash);
+	type = RX_CMP_IS_IPV6(rxcmp1) ? XDP_RSS_TYPE_L3_IPV6 :
+					XDP_RSS_TYPE_L3_IPV4;
+	if (bnxt_rx_hash_type(bp, RX_CMP_TYPE(rxcmp), rxcmp) ==
+	    PKT_HASH_TYPE_L4) {
+		itype = le32_to_cpu(rxcmp->rx_cmp_len_flags_type) &
+			RX_CMP_FLAGS_ITYPES_MASK;
+		if (itype == RX_CMP_FLAGS_ITYPE_TCP)
+			type |= XDP_RSS_L4_TCP;
+		else if (itype == RX_CMP_FLAGS_ITYPE_UDP)
+			type |= XDP_RSS_L4_UDP;
+		else
+			type |= XDP_RSS_L4;
+	}
+	*rss_type = type;
+	return 0;
+}
+
+#ifdef HAVE_XDP_METADATA_VLAN_TAG
+static int bnxt_xdp_rx_vlan_tag(const struct xdp_md *ctx, __be16 *vlan_proto,
+				u16 *vlan_tci)
+{
+	const struct bnxt_xdp_buff *bxdp = (void *)ctx;
+	struct rx_cmp_ext *rxcmp1 = bxdp->rxcmp1;
+	struct rx_cmp *rxcmp = bxdp->rxcmp;
+	u8 cmp_type = RX_CMP_TYPE(rxcmp);
+
+	if (!(bxdp->xdp.rxq->dev->features & BNXT_HW_FEATURE_VLAN_ALL_RX))
+		return -ENODATA;
+
+	if (cmp_type == CMP_TYPE_RX_L2_CMP) {
+		u32 meta_data;
+
+		if (!(rxcmp1->rx_cmp_flags2 &
+		      cpu_to_le32(RX_CMP_FLAGS2_META_FORMAT_VLAN)))
+			return -ENODATA;
+
+		meta_data = le32_to_cpu(rxcmp1->rx_cmp_meta_data);
+		*vlan_tci = meta_data & RX_CMP_FLAGS2_METADATA_TCI_MASK;
+		*vlan_proto = htons(meta_data >> RX_CMP_FLAGS2_METADATA_TPID_SFT);
+		return 0;
+	} else if (cmp_type == CMP_TYPE_RX_L2_V3_CMP &&
+		   RX_CMP_VLAN_VALID(rxcmp)) {
+		u32 tpid_sel = RX_CMP_VLAN_TPID_SEL(rxcmp);
+
+		if (tpid_sel == RX_CMP_METADATA1_TPID_8021Q)
+			*vlan_proto = htons(ETH_P_8021Q);
+		else if (tpid_sel == RX_CMP_METADATA1_TPID_8021AD)
+			*vlan_proto = htons(ETH_P_8021AD);
+		else
+			return -ENODATA;
+		*vlan_tci = RX_CMP_METADATA0_TCI(rxcmp1);
+		return 0;
+	}
+	return -ENODATA;
+}
+#endif
+
+static int bnxt_xdp_rx_timestamp(const struct xdp_md *ctx, u64 *timestamp)
+{
+#ifdef HAVE_IEEE1588_SUPPORT
+	const struct bnxt_xdp_buff *bxdp = (void *)ctx;
+	struct bnxt *bp = netdev_priv(bxdp->xdp.rxq->dev);
+	struct bnxt_ptp_cfg *ptp = bp->ptp_cfg;
+	u32 flags;
+	u64 ts = 0;
+
+	/* Older chips deliver the RX timestamp through a deferred firmware
+	 * query, only P5+ carries it in the completion.
+	 */
+	if (!ptp || !(bp->flags & BNXT_FLAG_CHIP_P5_PLUS))
+		return -ENODATA;
+
+	flags = le32_to_cpu(bxdp->rxcmp->rx_cmp_len_flags_type);
+	if ((flags & RX_CMP_FLAGS_ITYPES_MASK) != RX_CMP_FLAGS_ITYPE_PTP_W_TS &&
+	    !bp->ptp_all_rx_tstamp)
+		return -ENODATA;
+
+	bnxt_get_rx_ts_p5(bp, &ts, bxdp->rxcmp1->rx_cmp_timestamp);
+	spin_lock_bh(&ptp->ptp_lock);
+	*timestamp = timecounter_cyc2time(&ptp->tc, ts);
+	spin_unlock_bh(&ptp->ptp_lock);
+	return 0;
+#else
+	return -EOPNOTSUPP;
+#endif
+}
+
+static const struct xdp_metadata_ops bnxt_xdp_metadata_ops = {
+	.xmo_rx_timestamp	= bnxt_xdp_rx_timestamp,
+	.xmo_rx_hash		= bnxt_xdp_rx_hash,
+#ifdef HAVE_XDP_METADATA_VLAN_TAG
+	.xmo_rx_vlan_tag	= bnxt_xdp_rx_vlan_tag,
+#endif
+};
+#endif
+
 /* returns the following:
  * 1       - 1 packet successfully received
  * 0       - successful TPA_START, packet not completed yet
@@ -2698,7 +3240,8 @@ static int bnxt_rx_pkt(struct bnxt *bp, struct bnxt_cp_ring_info *cpr,
 	bool xdp_active = false;
 	dma_addr_t dma_addr;
 	struct sk_buff *skb;
-	struct xdp_buff xdp, *xdp_ptr;
+	struct bnxt_xdp_buff bxdp;
+	struct xdp_buff *xdp_ptr;
 	int rc = 0;
 	u32 vlan = 0;
 	u32 misc, flags;
@@ -2816,17 +3359,42 @@ static int bnxt_rx_pkt(struct bnxt *bp, struct bnxt_cp_ring_info *cpr,
 	len = flags >> RX_CMP_LEN_SHIFT;
 	dma_addr = rx_buf->mapping;
 	if (BNXT_RING_RX_ZC_MODE(rxr) && bnxt_xdp_attached(bp, rxr)) {
+#ifdef HAVE_XDP_METADATA_OPS
+		bnxt_xdp_buff_set_cmp(data, rxcmp, rxcmp1);
+#endif
+#ifdef HAVE_XSK_MULTI_BUFF
+		if (agg_bufs &&
+		    !bnxt_rx_agg_xsk(bp, cpr, data, cp_cons, agg_bufs)) {
+			bnxt_reuse_rx_data(rxr, cons, data);
+			cpr->sw_stats->rx.rx_oom_discards += 1;
+			rc = -ENOMEM;
+			goto next_rx;
+		}
+#endif
 		if (bnxt_rx_xsk(bp, rxr, cons, data, &data_ptr, &len, event)) {
 			rc = 1;
 			goto next_rx;
 		}
 		xdp_active = true;
 		xdp_ptr = data;
+#ifdef HAVE_XSK_MULTI_BUFF
+		if (agg_bufs) {
+			skb = bnxt_xsk_copy_skb(bnapi, data);
+			bnxt_reuse_rx_data(rxr, cons, data);
+			if (!skb) {
+				cpr->sw_stats->rx.rx_oom_discards += 1;
+				rc = -ENOMEM;
+				goto next_rx;
+			}
+			goto skb_ready;
+		}
+#endif
 		goto make_skb;
 	} else if (bnxt_xdp_attached(bp, rxr)) {
-		bnxt_xdp_buff_init(bp, rxr, cons, data_ptr, len, &xdp);
+		bnxt_xdp_buff_init(bp, rxr, cons, data_ptr, len, &bxdp.xdp);
+		bnxt_xdp_buff_set_cmp(&bxdp.xdp, rxcmp, rxcmp1);
 		if (agg_bufs) {
-			u32 frag_len = bnxt_rx_agg_pages_xdp(bp, cpr, &xdp,
+			u32 frag_len = bnxt_rx_agg_pages_xdp(bp, cpr, &bxdp.xdp,
 							     cp_cons, agg_bufs,
 							     false);
 			if (!frag_len) {
@@ -2836,7 +3404,7 @@ static int bnxt_rx_pkt(struct bnxt *bp, struct bnxt_cp_ring_info *cpr,
 			}
 		}
 		xdp_active = true;
-		xdp_ptr = &xdp;
+		xdp_ptr = &bxdp.xdp;
 	}
 
 #ifndef HAVE_XDP_MULTI_BUFF
@@ -2845,14 +3413,17 @@ static int bnxt_rx_pkt(struct bnxt *bp, struct bnxt_cp_ring_info *cpr,
 #else
 	if (xdp_active) {
 #endif
-		if (bnxt_rx_xdp(bp, rxr, cons, &xdp, data, &data_ptr, &len, event)) {
+		if (bnxt_rx_xdp(bp, rxr, cons, &bxdp.xdp, data, &data_ptr, &len,
+				event)) {
 			rc = 1;
 			goto next_rx;
 		}
 	}
 
 make_skb:
-	if (len <= bp->rx_copy_thresh) {
+	if (READ_ONCE(bp->rx_copybreak_adapt))
+		bnxt_rx_copybreak_update(bp, rxr, len);
+	if (len <= rxr->rx_copy_thresh) {
 		if (!xdp_active)
 			skb = bnxt_copy_skb(bnapi, data_ptr, len, dma_addr);
 		else
@@ -2865,7 +3436,7 @@ make_skb:
 							       agg_bufs, false);
 #ifdef HAVE_XDP_MULTI_BUFF
 				else
-					bnxt_xdp_buff_frags_free(rxr, &xdp);
+					bnxt_xdp_buff_frags_free(rxr, &bxdp.xdp);
 #endif
 			}
 			cpr->sw_stats->rx.rx_oom_discards += 1;
@@ -2895,6 +3466,8 @@ make_skb:
 	if (agg_bufs) {
 		if ((misc & RX_CMP_PAYLOAD_OFFSET) == (flags & RX_CMP_LEN))
 			cpr->sw_stats->rx.rx_hds += 1;
+		else
+			cpr->sw_stats->rx.rx_hds_no_split += 1;
 		if (!xdp_active) {
 			skb = bnxt_rx_agg_pages_skb(bp, cpr, skb, cp_cons, agg_bufs, false);
 			if (!skb) {
@@ -2904,10 +3477,11 @@ make_skb:
 			}
 #ifdef HAVE_XDP_MULTI_BUFF
 		} else {
-			skb = bnxt_xdp_build_skb(bp, skb, agg_bufs, rxr->page_pool, &xdp, rxcmp1);
+			skb = bnxt_xdp_build_skb(bp, skb, agg_bufs, rxr->page_pool,
+						 &bxdp.xdp, rxcmp1);
 			if (!skb) {
 				/* we should be able to free the old skb here */
-				bnxt_xdp_buff_frags_free(rxr, &xdp);
+				bnxt_xdp_buff_frags_free(rxr, &bxdp.xdp);
 				cpr->sw_stats->rx.rx_oom_discards += 1;
 				rc = -ENOMEM;
 				goto next_rx;
@@ -2916,21 +3490,13 @@ make_skb:
 		}
 	}
 
+#ifdef HAVE_XSK_MULTI_BUFF
+skb_ready:
+#endif
 	if (RX_CMP_HASH_VALID(rxcmp)) {
-		enum pkt_hash_types type;
+		enum pkt_hash_types type = bnxt_rx_hash_type(bp, cmp_type,
+							     rxcmp);
 
-		if (cmp_type == CMP_TYPE_RX_L2_V3_CMP) {
-			type = bnxt_rss_ext_op(bp, rxcmp);
-		} else {
-			u32 hash_type;
-
-			hash_type = RX_CMP_HASH_TYPE(rxcmp);
-			/* RSS profiles 1 and 3 with extract code 0 for inner 4-tuple */
-			if (hash_type != 1 && hash_type != 3)
-				type = PKT_HASH_TYPE_L3;
-			else
-				type = PKT_HASH_TYPE_L4;
-		}
 		skb_set_hash(skb, le32_to_cpu(rxcmp->rx_cmp_rss_hash), type);
 	}
 
@@ -3211,7 +3777,9 @@ static void bnxt_dbr_task(struct work_struct *work)
 	mutex_unlock(&dbr->lock);
 
 	rtnl_lock();
+	bnxt_netdev_lock(bp->dev);
 	if (!test_bit(BNXT_STATE_OPEN, &bp->state)) {
+		bnxt_netdev_unlock(bp->dev);
 		rtnl_unlock();
 		atomic_dec(&dbr->event_cnt);
 		return;
@@ -3245,7 +3813,7 @@ static void bnxt_dbr_task(struct work_struct *work)
 			}
 		}
 
-		napi_disable(&bnapi->napi);
+		bnxt_napi_disable(&bnapi->napi);
 
 		/* replay the last CP cons idx with ARMALL */
 		for (j = 0; j < cpr->cp_ring_count; j++) {
@@ -3276,7 +3844,7 @@ static void bnxt_dbr_task(struct work_struct *work)
 		bnxt_do_pacing_default(bp, &cpr->cp_ring_struct.seed);
 		bnxt_db_nq_arm(bp, &cpr->cp_db, cpr->cp_raw_cons);
 
-		napi_enable(&bnapi->napi);
+		bnxt_napi_enable(&bnapi->napi);
 
 		bnxt_for_each_napi_tx(j, bnapi, txr) {
 			WRITE_ONCE(txr->dev_state, 0);
@@ -3290,6 +3858,7 @@ static void bnxt_dbr_task(struct work_struct *work)
 		enable_irq(bp->irq_tbl[map_idx].vector);
 	}
 
+	bnxt_netdev_unlock(bp->dev);
 	rtnl_unlock();
 
 recovery_done:
@@ -4061,11 +4630,84 @@ static inline int bnxt_has_work(struct bnxt *bp, struct bnxt_cp_ring_info *cpr)
 	return TX_CMP_VALID(txcmp, raw_cons);
 }
 
+/* Prefetch only, completions are still processed one at a time by
+ * bnxt_rx_pkt().  Look ahead at up to BNXT_RX_PREFETCH_MAX completions
+ * starting at raw_cons and prefetch the packet headers of the plain RX L2
+ * completions found.  TX completions in between
+ * are stepped over; anything else stops the look-ahead.  Returns the raw
+ * completion index past the last completion examined.
+ */
+static u32 bnxt_rx_prefetch_ahead(struct bnxt *bp,
+				  struct bnxt_cp_ring_info *cpr,
+				  u32 raw_cons, int budget)
+{
+	struct bnxt_rx_ring_info *rxr = cpr->bnapi->rx_ring;
+	int max = min_t(int, budget, BNXT_RX_PREFETCH_MAX);
+	int n = 0;
+
+	if (!rxr || BNXT_RING_RX_ZC_MODE(rxr))
+		return raw_cons;
+
+	while (n < max) {
+		u32 tmp_raw_cons = NEXT_RAW_CMP(raw_cons);
+		u16 cp_cons = RING_CMP(raw_cons);
+		struct rx_cmp_ext *rxcmp1;
+		struct rx_cmp *rxcmp;
+		u8 cmp_type, agg_bufs;
+		u8 *data_ptr;
+		u16 cons;
+
+		rxcmp = (struct rx_cmp *)
+			&cpr->cp_desc_ring[CP_RING(cp_cons)][CP_IDX(cp_cons)];
+		if (!TX_CMP_VALID((struct tx_cmp *)rxcmp, raw_cons))
+			break;
+
+		dma_rmb();
+		cmp_type = RX_CMP_TYPE(rxcmp);
+		if (cmp_type == CMP_TYPE_TX_L2_CMP ||
+		    cmp_type == CMP_TYPE_TX_L2_COAL_CMP) {
+			raw_cons = tmp_raw_cons;
+			continue;
+		}
+		if (cmp_type != CMP_TYPE_RX_L2_CMP &&
+		    cmp_type != CMP_TYPE_RX_L2_V3_CMP)
+			break;
+
+		cp_cons = RING_CMP(tmp_raw_cons);
+		rxcmp1 = (struct rx_cmp_ext *)
+			&cpr->cp_desc_ring[CP_RING(cp_cons)][CP_IDX(cp_cons)];
+		if (!RX_CMP_VALID(rxcmp1, tmp_raw_cons))
+			break;
+
+		dma_rmb();
+		cons = rxcmp->rx_cmp_opaque;
+		if (unlikely(cons > bp->rx_ring_mask))
+			break;
+
+		data_ptr = rxr->rx_buf_ring[cons].data_ptr;
+		if (likely(data_ptr))
+			prefetch(data_ptr);
+		n++;
+
+		agg_bufs = (le32_to_cpu(rxcmp->rx_cmp_misc_v1) &
+			    RX_CMP_AGG_BUFS) >> RX_CMP_AGG_BUFS_SHIFT;
+		raw_cons = ADV_RAW_CMP(tmp_raw_cons, agg_bufs + 1);
+	}
+
+	if (!n)
+		return raw_cons;
+
+	cpr->sw_stats->rx.rx_prefetch_passes++;
+	cpr->sw_stats->rx.rx_prefetch_cmpls += n;
+	return raw_cons;
+}
+
 static int __bnxt_poll_work(struct bnxt *bp, struct bnxt_cp_ring_info *cpr,
 			    int budget)
 {
 	struct bnxt_napi *bnapi = cpr->bnapi;
 	u32 raw_cons = cpr->cp_raw_cons;
+	u32 prefetch_end = raw_cons;
 	u32 cons;
 	int rx_pkts = 0;
 	u8 event = 0;
@@ -4136,6 +4778,14 @@ static int __bnxt_poll_work(struct bnxt *bp, struct bnxt_cp_ring_info *cpr,
 					  NM_IRQ_PASS)
 				break;
 #endif
+			/* Look ahead again once the completions prefetched
+			 * last time have been consumed.
+			 */
+			if (likely(budget) && bp->rx_prefetch_en &&
+			    (s32)(raw_cons - prefetch_end) >= 0)
+				prefetch_end =
+					bnxt_rx_prefetch_ahead(bp, cpr, raw_cons,
+							       budget - rx_pkts);
 			if (likely(budget))
 				rc = bnxt_rx_pkt(bp, cpr, &raw_cons, &event);
 			else
@@ -4179,10 +4829,13 @@ static int __bnxt_poll_work(struct bnxt *bp, struct bnxt_cp_ring_info *cpr,
 		struct bnxt_tx_ring_info *txr = bnapi->tx_ring[0];
 		u16 prod = txr->tx_prod;
 
-		/* Sync BD data before updating doorbell */
+		/* All XDP_TX frames of this poll go out with one doorbell.
+		 * Sync BD data before updating doorbell.
+		 */
 		wmb();
 
 		bnxt_db_write_relaxed(bp, &txr->tx_db, prod);
+		cpr->sw_stats->cmn.xdp_tx_db++;
 		event &= ~BNXT_TX_EVENT;
 	}
 #ifdef DEV_NETMAP
@@ -4203,6 +4856,7 @@ static void __bnxt_poll_work_done(struct bnxt *bp, struct bnxt_napi *bnapi,
 		struct bnxt_rx_ring_info *rxr = bnapi->rx_ring;
 
 		bnxt_db_write(bp, &rxr->rx_db, rxr->rx_prod);
+		bnapi->cp_ring.sw_stats->rx.rx_refill_db++;
 		bnapi->events &= ~BNXT_RX_EVENT;
 	}
 	if (bnapi->events & BNXT_AGG_EVENT) {
@@ -4346,7 +5000,7 @@ static int bnxt_poll(struct napi_struct *napi, int budget)
 			break;
 		}
 	}
-	if (bp->flags & BNXT_FLAG_DIM) {
+	if (cpr->rx_dim_en) {
 		struct dim_sample dim_sample = {};
 
 		dim_update_sample(cpr->event_ctr,
@@ -4355,6 +5009,15 @@ static int bnxt_poll(struct napi_struct *napi, int budget)
 				  &dim_sample);
 		net_dim(&cpr->dim, dim_sample);
 	}
+	if (cpr->tx_dim_en) {
+		struct dim_sample dim_sample = {};
+
+		dim_update_sample(cpr->event_ctr,
+				  cpr->tx_packets,
+				  cpr->tx_bytes,
+				  &dim_sample);
+		net_dim(&cpr->tx_dim, dim_sample);
+	}
 	mmiowb();
 	bnxt_unlock_napi(bnapi);
 	return work_done;
@@ -4492,8 +5155,7 @@ static int bnxt_poll_p5(struct napi_struct *napi, int budget)
 	}
 poll_done:
 	cpr_rx = &cpr->cp_ring_arr[0];
-	if (cpr_rx->cp_ring_type == BNXT_NQ_HDL_TYPE_RX &&
-	    (bp->flags & BNXT_FLAG_DIM)) {
+	if (cpr_rx->cp_ring_type == BNXT_NQ_HDL_TYPE_RX && cpr->rx_dim_en) {
 		struct dim_sample dim_sample = {};
 
 		dim_update_sample(cpr->event_ctr,
@@ -4502,6 +5164,15 @@ poll_done:
 				  &dim_sample);
 		net_dim(&cpr->dim, dim_sample);
 	}
+	if (cpr->tx_dim_en) {
+		struct dim_sample dim_sample = {};
+
+		dim_update_sample(cpr->event_ctr,
+				  cpr->tx_packets,
+				  cpr->tx_bytes,
+				  &dim_sample);
+		net_dim(&cpr->tx_dim, dim_sample);
+	}
 
 #ifdef HAVE_XSK_SUPPORT
 	if ((bnapi->flags & BNXT_NAPI_FLAG_XDP) && bnapi->tx_ring[0]->xsk_pool)
@@ -4603,7 +5274,7 @@ static void bnxt_free_tx_skbs(struct bnxt *bp)
 					 DMA_TO_DEVICE);
 
 			last = tx_buf->nr_frags;
-			j += 2;
+			j += 2 + tx_buf->is_txtime;
 			for (k = 0; k < last; k++, j++) {
 				int ring_idx = j & bp->tx_ring_mask;
 				skb_frag_t *frag = &skb_shinfo(skb)->frags[k];
@@ -4622,7 +5293,7 @@ static void bnxt_free_tx_skbs(struct bnxt *bp)
 
 void bnxt_free_one_rx_buf_ring(struct bnxt *bp, struct bnxt_rx_ring_info *rxr)
 {
-	struct pci_dev *pdev = bp->pdev;
+	struct pci_dev __maybe_unused *pdev = bp->pdev;
 	int i, max_idx;
 
 	max_idx = bp->rx_nr_pages * RX_DESC_CNT;
@@ -4661,11 +5332,7 @@ void bnxt_free_one_rx_buf_ring(struct bnxt *bp, struct bnxt_rx_ring_info *rxr)
 			page_pool_recycle_direct(rxr->page_pool, data);
 #endif
 		} else {
-			dma_unmap_single_attrs(&pdev->dev, mapping,
-					       bp->rx_buf_use_size,
-					       bp->rx_dir,
-					       DMA_ATTR_WEAK_ORDERING);
-			skb_free_frag(data);
+			__bnxt_free_rx_frag(bp, rxr, data, mapping);
 		}
 #else
 		dma_unmap_single_attrs(&pdev->dev, mapping, bp->rx_buf_use_size,
@@ -4676,10 +5343,10 @@ void bnxt_free_one_rx_buf_ring(struct bnxt *bp, struct bnxt_rx_ring_info *rxr)
 	}
 }
 
-static void bnxt_free_one_rx_ring_skbs(struct bnxt *bp, int ring_nr)
+static void bnxt_free_one_rx_ring_skbs(struct bnxt *bp,
+				       struct bnxt_rx_ring_info *rxr)
 {
-	struct bnxt_rx_ring_info *rxr = &bp->rx_ring[ring_nr];
-	struct pci_dev *pdev = bp->pdev;
+	struct pci_dev __maybe_unused *pdev = bp->pdev;
 	struct bnxt_tpa_idx_map *map;
 	int i, max_agg_idx;
 
@@ -4698,15 +5365,14 @@ static void bnxt_free_one_rx_ring_skbs(struct bnxt *bp, int ring_nr)
 		if (!data)
 			continue;
 
-		dma_unmap_single_attrs(&pdev->dev, tpa_info->mapping,
-				       bp->rx_buf_use_size, bp->rx_dir,
-				       DMA_ATTR_WEAK_ORDERING);
-
 		tpa_info->data = NULL;
 
 #ifdef HAVE_BUILD_SKB
-		skb_free_frag(data);
+		__bnxt_free_rx_frag(bp, rxr, data, tpa_info->mapping);
 #else
+		dma_unmap_single_attrs(&pdev->dev, tpa_info->mapping,
+				       bp->rx_buf_use_size, bp->rx_dir,
+				       DMA_ATTR_WEAK_ORDERING);
 		dev_kfree_skb_any(data);
 #endif
 	}
@@ -4728,11 +5394,25 @@ skip_rx_buf_free:
 		if (!page)
 			continue;
 
+#ifdef HAVE_XSK_MULTI_BUFF
+		if (BNXT_RING_RX_ZC_MODE(rxr) && rxr->xsk_pool) {
+			xsk_buff_free(rx_agg_buf->xsk_buf);
+			rx_agg_buf->xsk_buf = NULL;
+			__clear_bit(i, rxr->rx_agg_bmap);
+			continue;
+		}
+#endif
 #ifndef HAVE_PAGE_POOL_GET_DMA_ADDR
 		dma_unmap_page_attrs(&pdev->dev, rx_agg_buf->mapping,
 				     BNXT_RX_PAGE_SIZE, bp->rx_dir,
 				     DMA_ATTR_WEAK_ORDERING);
 #endif
+#ifdef HAVE_BNXT_RX_NETMEM
+		page_pool_put_full_netmem(rxr->page_pool, rx_agg_buf->netmem,
+					  true);
+		rx_agg_buf->netmem = 0;
+		__clear_bit(i, rxr->rx_agg_bmap);
+#else
 		rx_agg_buf->page = NULL;
 		__clear_bit(i, rxr->rx_agg_bmap);
 		if (PAGE_SIZE <= BNXT_RX_PAGE_SIZE) {
@@ -4748,6 +5428,7 @@ skip_rx_buf_free:
 			__free_page(page);
 #endif
 		}
+#endif
 	}
 
 skip_rx_agg_free:
@@ -4758,6 +5439,7 @@ skip_rx_agg_free:
 	map = rxr->rx_tpa_idx_map;
 	if (map)
 		memset(map->agg_idx_bmap, 0, sizeof(map->agg_idx_bmap));
+	rxr->tpa_inflight = 0;
 }
 
 static void bnxt_free_rx_skbs(struct bnxt *bp)
@@ -4768,7 +5450,7 @@ static void bnxt_free_rx_skbs(struct bnxt *bp)
 		return;
 
 	for (i = 0; i < bp->rx_nr_rings; i++)
-		bnxt_free_one_rx_ring_skbs(bp, i);
+		bnxt_free_one_rx_ring_skbs(bp, &bp->rx_ring[i]);
 }
 
 static void bnxt_free_skbs(struct bnxt *bp)
@@ -4898,29 +5580,60 @@ int bnxt_alloc_ring(struct bnxt *bp, struct bnxt_ring_mem_info *rmem)
 	return 0;
 }
 
+static void bnxt_free_one_tpa_info(struct bnxt *bp,
+				   struct bnxt_rx_ring_info *rxr)
+{
+	int j;
+
+	kfree(rxr->rx_tpa_idx_map);
+	rxr->rx_tpa_idx_map = NULL;
+	if (rxr->rx_tpa) {
+		for (j = 0; j < bp->max_tpa; j++) {
+			kfree(rxr->rx_tpa[j].agg_arr);
+			rxr->rx_tpa[j].agg_arr = NULL;
+		}
+	}
+	kfree(rxr->rx_tpa);
+	rxr->rx_tpa = NULL;
+}
+
 static void bnxt_free_tpa_info(struct bnxt *bp)
 {
-	int i, j;
+	int i;
 
-	for (i = 0; i < bp->rx_nr_rings; i++) {
-		struct bnxt_rx_ring_info *rxr = &bp->rx_ring[i];
+	for (i = 0; i < bp->rx_nr_rings; i++)
+		bnxt_free_one_tpa_info(bp, &bp->rx_ring[i]);
+}
 
-		kfree(rxr->rx_tpa_idx_map);
-		rxr->rx_tpa_idx_map = NULL;
-		if (rxr->rx_tpa) {
-			for (j = 0; j < bp->max_tpa; j++) {
-				kfree(rxr->rx_tpa[j].agg_arr);
-				rxr->rx_tpa[j].agg_arr = NULL;
-			}
-		}
-		kfree(rxr->rx_tpa);
-		rxr->rx_tpa = NULL;
+static int bnxt_alloc_one_tpa_info(struct bnxt *bp,
+				   struct bnxt_rx_ring_info *rxr)
+{
+	struct rx_agg_cmp *agg;
+	int j;
+
+	rxr->rx_tpa = kcalloc(bp->max_tpa, sizeof(struct bnxt_tpa_info),
+			      GFP_KERNEL);
+	if (!rxr->rx_tpa)
+		return -ENOMEM;
+
+	if (!(bp->flags & BNXT_FLAG_CHIP_P5_PLUS))
+		return 0;
+	for (j = 0; j < bp->max_tpa; j++) {
+		agg = kcalloc(MAX_SKB_FRAGS, sizeof(*agg), GFP_KERNEL);
+		if (!agg)
+			return -ENOMEM;
+		rxr->rx_tpa[j].agg_arr = agg;
 	}
+	rxr->rx_tpa_idx_map = kzalloc(sizeof(*rxr->rx_tpa_idx_map),
+				      GFP_KERNEL);
+	if (!rxr->rx_tpa_idx_map)
+		return -ENOMEM;
+	return 0;
 }
 
 static int bnxt_alloc_tpa_info(struct bnxt *bp)
 {
-	int i, j;
+	int i, rc;
 
 	bp->max_tpa = MAX_TPA;
 	if (bp->flags & BNXT_FLAG_CHIP_P5_PLUS) {
@@ -4930,26 +5643,9 @@ static int bnxt_alloc_tpa_info(struct bnxt *bp)
 	}
 
 	for (i = 0; i < bp->rx_nr_rings; i++) {
-		struct bnxt_rx_ring_info *rxr = &bp->rx_ring[i];
-		struct rx_agg_cmp *agg;
-
-		rxr->rx_tpa = kcalloc(bp->max_tpa, sizeof(struct bnxt_tpa_info),
-				      GFP_KERNEL);
-		if (!rxr->rx_tpa)
-			return -ENOMEM;
-
-		if (!(bp->flags & BNXT_FLAG_CHIP_P5_PLUS))
-			continue;
-		for (j = 0; j < bp->max_tpa; j++) {
-			agg = kcalloc(MAX_SKB_FRAGS, sizeof(*agg), GFP_KERNEL);
-			if (!agg)
-				return -ENOMEM;
-			rxr->rx_tpa[j].agg_arr = agg;
-		}
-		rxr->rx_tpa_idx_map = kzalloc(sizeof(*rxr->rx_tpa_idx_map),
-					      GFP_KERNEL);
-		if (!rxr->rx_tpa_idx_map)
-			return -ENOMEM;
+		rc = bnxt_alloc_one_tpa_info(bp, &bp->rx_ring[i]);
+		if (rc)
+			return rc;
 	}
 	return 0;
 }
@@ -4976,6 +5672,8 @@ static void bnxt_free_rx_rings(struct bnxt *bp)
 			xdp_rxq_info_unreg(&rxr->xdp_rxq);
 #endif
 #ifdef CONFIG_PAGE_POOL
+		page_pool_destroy(rxr->head_pool);
+		rxr->head_pool = NULL;
 		page_pool_destroy(rxr->page_pool);
 		rxr->page_pool = NULL;
 #endif
@@ -5014,20 +5712,96 @@ static int bnxt_alloc_rx_page_pool(struct bnxt *bp, struct bnxt_rx_ring_info *rx
 	pp.flags |= PP_FLAG_DMA_SYNC_DEV;
 	if (PAGE_SIZE > BNXT_RX_PAGE_SIZE)
 		pp.flags |= PP_FLAG_PAGE_FRAG;
+#ifdef HAVE_BNXT_RX_NETMEM
+	/* Outside of XDP page mode this pool only backs the aggregation
+	 * ring, so let a memory provider bound to the queue supply it.
+	 * Head buffers always stay in readable host memory.
+	 */
+	if (!BNXT_RX_PAGE_MODE(bp)) {
+		pp.netdev = bp->dev;
+		pp.queue_idx = rxr->bnapi->index;
+		pp.flags |= PP_FLAG_ALLOW_UNREADABLE_NETMEM;
+	}
+#endif
 	rxr->page_pool = page_pool_create(&pp);
 	if (IS_ERR(rxr->page_pool)) {
 		int err = PTR_ERR(rxr->page_pool);
 		rxr->page_pool = NULL;
 		return err;
 	}
+#ifdef HAVE_BNXT_RX_HEAD_POOL
+	if (bnxt_rx_head_pool_en(bp)) {
+		struct page_pool *pool;
+
+		pp.pool_size = bp->rx_ring_size;
+		pp.max_len = PAGE_SIZE;
+		pp.flags = PP_FLAG_DMA_MAP | PP_FLAG_DMA_SYNC_DEV |
+			   PP_FLAG_PAGE_FRAG;
+		pool = page_pool_create(&pp);
+		if (IS_ERR(pool)) {
+			page_pool_destroy(rxr->page_pool);
+			rxr->page_pool = NULL;
+			return PTR_ERR(pool);
+		}
+		rxr->head_pool = pool;
+	}
+#endif
 	return 0;
 }
 #else
-static int bnxt_alloc_rx_page_pool(struct bnxt *bp, struct bnxt_rx_ring_info *rxr, int numa_node)
-{
-	return 0;
-}
+static int bnxt_alloc_rx_page_pool(struct bnxt *bp, struct bnxt_rx_ring_info *rxr, int numa_node)
+{
+	return 0;
+}
+#endif
+
+static int bnxt_rx_ring_reg_xdp_rxq(struct bnxt *bp,
+				    struct bnxt_rx_ring_info *rxr, int idx)
+{
+	int rc = 0;
+
+#ifdef HAVE_XDP_RXQ_INFO
+	rc = xdp_rxq_info_reg(&rxr->xdp_rxq, bp->dev, idx, 0);
+	if (rc < 0)
+		return rc;
+
+#ifdef HAVE_XSK_SUPPORT
+	rxr->xsk_pool = xsk_get_pool_from_qid(bp->dev, idx);
+	if (BNXT_CHIP_P5_PLUS(bp) && test_bit(idx, bp->af_xdp_zc_qs) &&
+	    rxr->xsk_pool && bp->xdp_prog &&
+	    xsk_buff_can_alloc(rxr->xsk_pool, bp->rx_ring_size)) {
+		rc = xdp_rxq_info_reg_mem_model(&rxr->xdp_rxq,
+						MEM_TYPE_XSK_BUFF_POOL, NULL);
+		rxr->flags |= BNXT_RING_FLAG_AF_XDP_ZC;
+		xsk_pool_set_rxq_info(rxr->xsk_pool, &rxr->xdp_rxq);
+		netdev_dbg(bp->dev, "%s(): AF_XDP_ZC flag set for rxring:%d\n",
+			   __func__, idx);
+	} else {
+		rc = xdp_rxq_info_reg_mem_model(&rxr->xdp_rxq,
+#ifndef CONFIG_PAGE_POOL
+						MEM_TYPE_PAGE_SHARED, NULL);
+#else
+						MEM_TYPE_PAGE_POOL, rxr->page_pool);
+#endif
+		rxr->flags &= ~BNXT_RING_FLAG_AF_XDP_ZC;
+		netdev_dbg(bp->dev, "%s(): AF_XDP_ZC flag RESET for rxring:%d\n",
+			   __func__, idx);
+	}
+#else /* HAVE_XSK_SUPPORT */
+	rc = xdp_rxq_info_reg_mem_model(&rxr->xdp_rxq,
+#ifndef CONFIG_PAGE_POOL
+					MEM_TYPE_PAGE_SHARED, NULL);
+#else
+					MEM_TYPE_PAGE_POOL, rxr->page_pool);
 #endif
+#endif /* HAVE_XSK_SUPPORT */
+	if (rc) {
+		xdp_rxq_info_unreg(&rxr->xdp_rxq);
+		return rc;
+	}
+#endif /* HAVE_XDP_RXQ_INFO */
+	return rc;
+}
 
 static int bnxt_alloc_rx_rings(struct bnxt *bp)
 {
@@ -5055,46 +5829,9 @@ static int bnxt_alloc_rx_rings(struct bnxt *bp)
 		if (rc)
 			return rc;
 
-#ifdef HAVE_XDP_RXQ_INFO
-		rc = xdp_rxq_info_reg(&rxr->xdp_rxq, bp->dev, i, 0);
-		if (rc < 0)
-			return rc;
-
-#ifdef HAVE_XSK_SUPPORT
-		rxr->xsk_pool = xsk_get_pool_from_qid(bp->dev, i);
-		if (BNXT_CHIP_P5_PLUS(bp) && test_bit(i, bp->af_xdp_zc_qs) &&
-		    rxr->xsk_pool && bp->xdp_prog &&
-		    xsk_buff_can_alloc(rxr->xsk_pool, bp->rx_ring_size)) {
-			rc = xdp_rxq_info_reg_mem_model(&rxr->xdp_rxq,
-							MEM_TYPE_XSK_BUFF_POOL, NULL);
-			rxr->flags |= BNXT_RING_FLAG_AF_XDP_ZC;
-			xsk_pool_set_rxq_info(rxr->xsk_pool, &rxr->xdp_rxq);
-			netdev_dbg(bp->dev, "%s(): AF_XDP_ZC flag set for rxring:%d\n",
-				   __func__, i);
-		} else {
-			rc = xdp_rxq_info_reg_mem_model(&rxr->xdp_rxq,
-#ifndef CONFIG_PAGE_POOL
-							MEM_TYPE_PAGE_SHARED, NULL);
-#else
-							MEM_TYPE_PAGE_POOL, rxr->page_pool);
-#endif
-			rxr->flags &= ~BNXT_RING_FLAG_AF_XDP_ZC;
-			netdev_dbg(bp->dev, "%s(): AF_XDP_ZC flag RESET for rxring:%d\n",
-				   __func__, i);
-		}
-#else /* HAVE_XSK_SUPPORT */
-		rc = xdp_rxq_info_reg_mem_model(&rxr->xdp_rxq,
-#ifndef CONFIG_PAGE_POOL
-						MEM_TYPE_PAGE_SHARED, NULL);
-#else
-						MEM_TYPE_PAGE_POOL, rxr->page_pool);
-#endif
-#endif /* HAVE_XSK_SUPPORT */
-		if (rc) {
-			xdp_rxq_info_unreg(&rxr->xdp_rxq);
+		rc = bnxt_rx_ring_reg_xdp_rxq(bp, rxr, i);
+		if (rc)
 			return rc;
-		}
-#endif /* HAVE_XDP_RXQ_INFO */
 
 		rc = bnxt_alloc_ring(bp, &ring->ring_mem);
 		if (rc)
@@ -5505,9 +6242,9 @@ static void bnxt_init_rxbd_pages(struct bnxt_ring_struct *ring, u32 type)
 	}
 }
 
-static int bnxt_alloc_one_rx_ring(struct bnxt *bp, int ring_nr)
+static int bnxt_alloc_one_rx_ring(struct bnxt *bp,
+				  struct bnxt_rx_ring_info *rxr, int ring_nr)
 {
-	struct bnxt_rx_ring_info *rxr = &bp->rx_ring[ring_nr];
 	struct net_device *dev = bp->dev;
 	u32 prod;
 	int i;
@@ -5546,7 +6283,7 @@ static int bnxt_alloc_one_rx_ring(struct bnxt *bp, int ring_nr)
 #endif
 
 		for (i = 0; i < bp->max_tpa; i++) {
-			data = __bnxt_alloc_rx_frag(bp, &mapping, GFP_KERNEL);
+			data = __bnxt_alloc_rx_frag(bp, &mapping, rxr, GFP_KERNEL);
 			if (!data)
 				return -ENOMEM;
 
@@ -5562,10 +6299,19 @@ static int bnxt_alloc_one_rx_ring(struct bnxt *bp, int ring_nr)
 	return 0;
 }
 
-static int bnxt_init_one_rx_ring(struct bnxt *bp, int ring_nr)
+/* AF_XDP zero-copy aggregation buffers are XSK frames, not pages */
+static u32 bnxt_rx_agg_buf_size(struct bnxt *bp, struct bnxt_rx_ring_info *rxr)
+{
+#ifdef HAVE_XSK_MULTI_BUFF
+	if (BNXT_RING_RX_ZC_MODE(rxr) && rxr->xsk_pool)
+		return xsk_pool_get_rx_frame_size(rxr->xsk_pool);
+#endif
+	return BNXT_RX_PAGE_SIZE;
+}
+
+static void bnxt_init_one_rx_ring_rxbd(struct bnxt *bp,
+				       struct bnxt_rx_ring_info *rxr)
 {
-	struct bnxt_rx_ring_info *rxr;
-	struct bnxt_ring_struct *ring;
 	u32 type;
 
 	type = (bp->rx_buf_use_size << RX_BD_LEN_SHIFT) |
@@ -5574,9 +6320,26 @@ static int bnxt_init_one_rx_ring(struct bnxt *bp, int ring_nr)
 	if (NET_IP_ALIGN == 2)
 		type |= RX_BD_FLAGS_SOP;
 
+	bnxt_init_rxbd_pages(&rxr->rx_ring_struct, type);
+
+	if ((bp->flags & BNXT_FLAG_AGG_RINGS)) {
+		type = (bnxt_rx_agg_buf_size(bp, rxr) << RX_BD_LEN_SHIFT) |
+			RX_BD_TYPE_RX_AGG_BD | RX_BD_FLAGS_SOP;
+
+		bnxt_init_rxbd_pages(&rxr->rx_agg_ring_struct, type);
+	}
+}
+
+static int bnxt_init_one_rx_ring(struct bnxt *bp, int ring_nr)
+{
+	struct bnxt_rx_ring_info *rxr;
+	struct bnxt_ring_struct *ring;
+
 	rxr = &bp->rx_ring[ring_nr];
-	ring = &rxr->rx_ring_struct;
-	bnxt_init_rxbd_pages(ring, type);
+	bnxt_init_one_rx_ring_rxbd(bp, rxr);
+
+	bnxt_rx_copybreak_reset(bp, rxr);
+	rxr->tpa_inflight = 0;
 
 #ifdef HAVE_NDO_XDP
 	if (BNXT_RX_PAGE_MODE(bp) && bp->xdp_prog) {
@@ -5595,19 +6358,76 @@ static int bnxt_init_one_rx_ring(struct bnxt *bp, int ring_nr)
 	}
 #endif
 
+	ring = &rxr->rx_ring_struct;
 	ring->fw_ring_id = INVALID_HW_RING_ID;
 
 	ring = &rxr->rx_agg_ring_struct;
 	ring->fw_ring_id = INVALID_HW_RING_ID;
 
-	if ((bp->flags & BNXT_FLAG_AGG_RINGS)) {
-		type = ((u32)BNXT_RX_PAGE_SIZE << RX_BD_LEN_SHIFT) |
-			RX_BD_TYPE_RX_AGG_BD | RX_BD_FLAGS_SOP;
+	return bnxt_alloc_one_rx_ring(bp, rxr, ring_nr);
+}
+
+/* The per queue RX settings that apply to a NAPI, if any.  RX NAPIs come
+ * first, so the NAPI index is the RX queue.
+ */
+static struct bnxt_queue_coal *bnxt_napi_rx_queue_coal(struct bnxt *bp,
+						       struct bnxt_napi *bnapi)
+{
+	struct bnxt_queue_coal *qc;
+
+	if (!bnapi->rx_ring)
+		return NULL;
+	qc = bnxt_queue_coal(bp, bnapi->index);
+	return qc && (qc->flags & BNXT_QUEUE_COAL_RX) ? qc : NULL;
+}
+
+static struct bnxt_queue_coal *bnxt_napi_tx_queue_coal(struct bnxt *bp,
+						       struct bnxt_napi *bnapi)
+{
+	struct bnxt_queue_coal *qc;
+
+	if (!BNXT_NAPI_TX_COAL(bp, bnapi) ||
+	    (bnapi->flags & BNXT_NAPI_FLAG_XDP))
+		return NULL;
+	qc = bnxt_queue_coal(bp, bnapi->tx_ring[0]->txq_index);
+	return qc && (qc->flags & BNXT_QUEUE_COAL_TX) ? qc : NULL;
+}
+
+/* Set a NAPI's coalescing, and whether DIM runs on it, from the global
+ * ethtool settings and then from the per queue settings of its queue.
+ */
+static void bnxt_init_napi_coal(struct bnxt *bp, struct bnxt_napi *bnapi)
+{
+	struct bnxt_cp_ring_info *cpr = &bnapi->cp_ring;
+	struct bnxt_queue_coal *qc;
 
-		bnxt_init_rxbd_pages(ring, type);
+	cpr->rx_ring_coal.coal_ticks = bp->rx_coal.coal_ticks;
+	cpr->rx_ring_coal.coal_bufs = bp->rx_coal.coal_bufs;
+	cpr->tx_ring_coal.coal_ticks = bp->tx_coal.coal_ticks;
+	cpr->tx_ring_coal.coal_bufs = bp->tx_coal.coal_bufs;
+	cpr->rx_dim_en = bnapi->rx_ring && (bp->flags & BNXT_FLAG_DIM);
+	cpr->tx_dim_en = BNXT_NAPI_TX_COAL(bp, bnapi) &&
+			 !(bnapi->flags & BNXT_NAPI_FLAG_XDP) && bp->tx_dim_en;
+
+	qc = bnxt_napi_rx_queue_coal(bp, bnapi);
+	if (qc) {
+		cpr->rx_dim_en = qc->rx_dim_en;
+		if (!qc->rx_dim_en) {
+			cpr->rx_ring_coal.coal_ticks = qc->rx_coal_ticks;
+			cpr->rx_ring_coal.coal_bufs = qc->rx_coal_bufs;
+		}
+	}
+	qc = bnxt_napi_tx_queue_coal(bp, bnapi);
+	if (qc) {
+		cpr->tx_dim_en = qc->tx_dim_en;
+		if (!qc->tx_dim_en) {
+			cpr->tx_ring_coal.coal_ticks = qc->tx_coal_ticks;
+			cpr->tx_ring_coal.coal_bufs = qc->tx_coal_bufs;
+		}
 	}
 
-	return bnxt_alloc_one_rx_ring(bp, ring_nr);
+	if (!cpr->rx_dim_en && !cpr->tx_dim_en)
+		bnxt_dim_tx_cmpl_update(bnapi, NULL);
 }
 
 static void bnxt_init_cp_rings(struct bnxt *bp)
@@ -5619,8 +6439,7 @@ static void bnxt_init_cp_rings(struct bnxt *bp)
 		struct bnxt_ring_struct *ring = &cpr->cp_ring_struct;
 
 		ring->fw_ring_id = INVALID_HW_RING_ID;
-		cpr->rx_ring_coal.coal_ticks = bp->rx_coal.coal_ticks;
-		cpr->rx_ring_coal.coal_bufs = bp->rx_coal.coal_bufs;
+		bnxt_init_napi_coal(bp, bp->bnapi[i]);
 		if (!cpr->cp_ring_arr)
 			continue;
 		for (j = 0; j < cpr->cp_ring_count; j++) {
@@ -5667,6 +6486,10 @@ static int bnxt_init_tx_rings(struct bnxt *bp)
 		struct bnxt_ring_struct *ring = &txr->tx_ring_struct;
 
 		ring->fw_ring_id = INVALID_HW_RING_ID;
+		txr->tx_cmpl_bds = 0;
+		txr->tx_cmpl_bytes = 0;
+		txr->tx_cmpl_max_bds = BNXT_TX_CMPL_MAX_BDS;
+		txr->tx_push_backoff = 0;
 	}
 
 	return 0;
@@ -5882,7 +6705,14 @@ void bnxt_set_ring_params(struct bnxt *bp)
 	if (bp->flags & BNXT_FLAG_TPA)
 		agg_factor = min_t(u32, 4, 65536 / BNXT_RX_PAGE_SIZE);
 
-	bp->flags &= ~BNXT_FLAG_JUMBO;
+	bp->flags &= ~(BNXT_FLAG_JUMBO | BNXT_FLAG_HDS);
+	/* Header-data split needs the aggregation ring for the payload */
+	if (bp->hds_cfg == BNXT_HDS_ON && !BNXT_RX_PAGE_MODE(bp) &&
+	    !(bp->flags & BNXT_FLAG_NO_AGG_RINGS)) {
+		bp->flags |= BNXT_FLAG_HDS;
+		if (!agg_factor)
+			agg_factor = min_t(u32, 4, 65536 / BNXT_RX_PAGE_SIZE);
+	}
 	if (rx_space > PAGE_SIZE && !(bp->flags & BNXT_FLAG_NO_AGG_RINGS)) {
 		u32 jumbo_factor;
 
@@ -5929,6 +6759,15 @@ void bnxt_set_ring_params(struct bnxt *bp)
 		}
 	}
 
+#ifdef HAVE_BNXT_RX_HEAD_POOL
+	/* Without XDP the head buffer only needs NET_SKB_PAD of headroom.
+	 * Keeping it tight lets two standard MTU buffers share a 4K page
+	 * in the head page pool.
+	 */
+	if (!BNXT_RX_PAGE_MODE(bp) && !agg_factor)
+		rx_space = rx_size + NET_SKB_PAD +
+			   SKB_DATA_ALIGN(sizeof(struct skb_shared_info));
+#endif
 	bp->rx_buf_use_size = rx_size;
 	bp->rx_buf_size = rx_space;
 
@@ -6130,6 +6969,8 @@ static void bnxt_free_hwrm_resources(struct bnxt *bp)
 
 	dma_pool_destroy(bp->hwrm_dma_pool);
 	bp->hwrm_dma_pool = NULL;
+	vfree(bp->hwrm_stats);
+	bp->hwrm_stats = NULL;
 
 	rcu_read_lock();
 	__hlist_for_each_entry_rcu(token, dummy, &bp->hwrm_pending_list, node)
@@ -6145,6 +6986,10 @@ static int bnxt_alloc_hwrm_resources(struct bnxt *bp)
 	if (!bp->hwrm_dma_pool)
 		return -ENOMEM;
 
+	/* Latency accounting is best effort, HWRM works without it */
+	bp->hwrm_stats = vzalloc((BNXT_HWRM_STATS_MAX_TYPE + 1) *
+				 sizeof(*bp->hwrm_stats));
+
 	INIT_HLIST_HEAD(&bp->hwrm_pending_list);
 
 	return 0;
@@ -6670,6 +7515,8 @@ static void bnxt_del_fltr(struct bnxt *bp, struct bnxt_filter_base *fltr)
 {
 	hlist_del(&fltr->hash);
 	bnxt_del_one_usr_fltr(bp, fltr);
+	if (test_and_clear_bit(BNXT_FLTR_PENDING, &fltr->state))
+		atomic_dec(&bp->ntp_fltr_pending);
 	if (fltr->flags) {
 		clear_bit(fltr->sw_id, bp->ntp_fltr_bmap);
 		bp->ntp_fltr_count--;
@@ -6684,7 +7531,8 @@ static void bnxt_free_ntp_fltrs(struct bnxt *bp, bool all)
 	/* Under rtnl_lock and all our NAPIs have been disabled.  It's
 	 * safe to delete the hash table.
 	 */
-	for (i = 0; i < BNXT_NTP_FLTR_HASH_SIZE; i++) {
+	llist_del_all(&bp->ntp_fltr_new_list);
+	for (i = 0; i < bp->ntp_fltr_hash_size; i++) {
 		struct hlist_head *head;
 		struct hlist_node *tmp, __maybe_unused *nxt;
 		struct bnxt_ntuple_filter *fltr;
@@ -6704,25 +7552,43 @@ static void bnxt_free_ntp_fltrs(struct bnxt *bp, bool all)
 	bitmap_free(bp->ntp_fltr_bmap);
 	bp->ntp_fltr_bmap = NULL;
 	bp->ntp_fltr_count = 0;
+	bp->ntp_fltr_hash_size = 0;
+	bp->ntp_fltr_hash_mask = 0;
+	kvfree(bp->ntp_fltr_hash_tbl);
+	bp->ntp_fltr_hash_tbl = NULL;
+	atomic_set(&bp->ntp_fltr_pending, 0);
 }
 
 static int bnxt_alloc_ntp_fltrs(struct bnxt *bp)
 {
-	int i, rc = 0;
+	u32 i, size;
 
 	if (!(bp->flags & BNXT_FLAG_RFS) || bp->ntp_fltr_bmap)
 		return 0;
 
-	for (i = 0; i < BNXT_NTP_FLTR_HASH_SIZE; i++)
+	size = roundup_pow_of_two(max_t(u32, bp->max_fltr /
+					BNXT_NTP_FLTR_BUCKET_DEPTH,
+					BNXT_NTP_FLTR_HASH_SIZE));
+	bp->ntp_fltr_hash_tbl = kvmalloc_array(size, sizeof(struct hlist_head),
+					       GFP_KERNEL);
+	if (!bp->ntp_fltr_hash_tbl)
+		return -ENOMEM;
+
+	for (i = 0; i < size; i++)
 		INIT_HLIST_HEAD(&bp->ntp_fltr_hash_tbl[i]);
 
 	bp->ntp_fltr_count = 0;
+	bp->ntp_fltr_expire_idx = 0;
+	atomic_set(&bp->ntp_fltr_pending, 0);
 	bp->ntp_fltr_bmap = bitmap_zalloc(bp->max_fltr, GFP_KERNEL);
-
-	if (!bp->ntp_fltr_bmap)
-		rc = -ENOMEM;
-
-	return rc;
+	if (!bp->ntp_fltr_bmap) {
+		kvfree(bp->ntp_fltr_hash_tbl);
+		bp->ntp_fltr_hash_tbl = NULL;
+		return -ENOMEM;
+	}
+	bp->ntp_fltr_hash_size = size;
+	bp->ntp_fltr_hash_mask = size - 1;
+	return 0;
 }
 
 static void bnxt_free_l2_filters(struct bnxt *bp, bool all)
@@ -7344,7 +8210,7 @@ static u32 bnxt_toeplitz(struct bnxt *bp, struct flow_keys *fkeys, const unsigne
 	}
 
 	/* The valid part of the hash is in the upper 32 bits. */
-	return (hash >> 32) & BNXT_NTP_FLTR_HASH_MASK;
+	return (hash >> 32) & bp->ntp_fltr_hash_mask;
 }
 
 #ifdef CONFIG_RFS_ACCEL
@@ -7615,11 +8481,12 @@ static void bnxt_cfg_rfs_ring_tbl_idx(struct bnxt *bp,
 	req->rfs_ring_tbl_idx = cpu_to_le16(rxq);
 }
 
-int bnxt_hwrm_cfa_ntuple_filter_alloc(struct bnxt *bp,
-				      struct bnxt_ntuple_filter *fltr)
+static int
+bnxt_hwrm_cfa_ntuple_filter_init(struct bnxt *bp,
+				 struct hwrm_cfa_ntuple_filter_alloc_input **reqp,
+				 struct bnxt_ntuple_filter *fltr)
 {
 	bool cap_ring_dst = bp->fw_cap & BNXT_FW_CAP_CFA_RFS_RING_TBL_IDX_V2;
-	struct hwrm_cfa_ntuple_filter_alloc_output *resp;
 	struct hwrm_cfa_ntuple_filter_alloc_input *req;
 	struct bnxt_flow_masks *masks = &fltr->fmasks;
 	struct flow_keys *keys = &fltr->fkeys;
@@ -7690,6 +8557,20 @@ int bnxt_hwrm_cfa_ntuple_filter_alloc(struct bnxt *bp,
 	req->src_port_mask = masks->ports.src;
 	req->dst_port = keys->ports.dst;
 	req->dst_port_mask = masks->ports.dst;
+	*reqp = req;
+	return 0;
+}
+
+int bnxt_hwrm_cfa_ntuple_filter_alloc(struct bnxt *bp,
+				      struct bnxt_ntuple_filter *fltr)
+{
+	struct hwrm_cfa_ntuple_filter_alloc_output *resp;
+	struct hwrm_cfa_ntuple_filter_alloc_input *req;
+	int rc;
+
+	rc = bnxt_hwrm_cfa_ntuple_filter_init(bp, &req, fltr);
+	if (rc)
+		return rc;
 
 	resp = hwrm_req_hold(bp, req);
 	rc = hwrm_req_send(bp, req);
@@ -7700,6 +8581,32 @@ int bnxt_hwrm_cfa_ntuple_filter_alloc(struct bnxt *bp,
 	return rc;
 }
 
+/* Program a newly queued aRFS filter and account its install latency */
+static int bnxt_ntp_fltr_install(struct bnxt *bp,
+				 struct bnxt_ntuple_filter *fltr)
+{
+	atomic64_t *counters = bp->ntp_fltr_counters;
+	s64 lat;
+	int rc;
+
+	rc = bnxt_hwrm_cfa_ntuple_filter_alloc(bp, fltr);
+	if (rc) {
+		atomic64_inc(&counters[BNXT_NTP_FLTR_INSTALL_ERR]);
+		return rc;
+	}
+	set_bit(BNXT_FLTR_VALID, &fltr->base.state);
+	if (test_and_clear_bit(BNXT_FLTR_PENDING, &fltr->base.state))
+		atomic_dec(&bp->ntp_fltr_pending);
+
+	/* Only bnxt_sp_task() updates these, no need for cmpxchg */
+	lat = ktime_us_delta(ktime_get(), fltr->queued);
+	atomic64_inc(&counters[BNXT_NTP_FLTR_INSTALL]);
+	atomic64_add(lat, &counters[BNXT_NTP_FLTR_LAT_TOTAL_US]);
+	if (lat > atomic64_read(&counters[BNXT_NTP_FLTR_LAT_MAX_US]))
+		atomic64_set(&counters[BNXT_NTP_FLTR_LAT_MAX_US], lat);
+	return 0;
+}
+
 static int bnxt_hwrm_set_vnic_filter(struct bnxt *bp, u16 vnic_id, u16 idx,
 				     const u8 *mac_addr)
 {
@@ -7811,15 +8718,30 @@ int bnxt_hwrm_vnic_set_tpa(struct bnxt *bp, struct bnxt_vnic_info *vnic,
 			nsegs = (MAX_SKB_FRAGS - n) / n;
 		}
 
+		/* max_agg_segs is a segment count on P5+ and in log2 units
+		 * on older chips.
+		 */
 		if (bp->flags & BNXT_FLAG_CHIP_P5_PLUS) {
-			segs = MAX_TPA_SEGS_P5;
+			segs = max_t(u32, MAX_TPA_SEGS_P5 >> bp->tpa_adapt_lvl,
+				     1);
+			bp->tpa_seg_limit = segs;
 			max_aggs = bp->max_tpa;
 		} else {
 			segs = ilog2(nsegs);
+			segs -= min_t(u32, segs, bp->tpa_adapt_lvl);
+			bp->tpa_seg_limit = 1 << segs;
 		}
 		req->max_agg_segs = cpu_to_le16(segs);
 		req->max_aggs = cpu_to_le16(max_aggs);
 
+		if (bp->tpa_timer_dflt) {
+			u32 timer = bp->tpa_timer_dflt >> bp->tpa_adapt_lvl;
+
+			req->enables |=
+				cpu_to_le32(VNIC_TPA_CFG_REQ_ENABLES_MAX_AGG_TIMER);
+			req->max_agg_timer = cpu_to_le32(max_t(u32, timer, 1));
+		}
+
 		req->min_agg_len = cpu_to_le32(512);
 		bnxt_hwrm_vnic_update_tunl_tpa(bp, req);
 	}
@@ -7958,6 +8880,8 @@ static void bnxt_fill_hw_rss_tbl_p5(struct bnxt *bp,
 			else
 				j = bp->rss_indir_tbl[i];
 		}
+		if (bp->rss_skip_ring && j == bp->rss_skip_ring)
+			j = (j + 1) % bp->rx_nr_rings;
 		rxr = &bp->rx_ring[j];
 
 		ring_id = rxr->rx_ring_struct.fw_ring_id;
@@ -7997,7 +8921,18 @@ static void bnxt_free_tc_etf_bitmap(struct bnxt *bp)
 	bp->etf_tx_ring_map = NULL;
 }
 
-static void bnxt_set_txr_etf_bmap(struct bnxt *bp)
+bool bnxt_tx_edt_supported(struct bnxt *bp)
+{
+	/* The so_txtime driver currently supports only phc RTC mode */
+	return BNXT_SUPPORTS_ETF(bp) && bp->ptp_cfg &&
+	       BNXT_PTP_USE_RTC(bp) && bp->etf_tx_ring_map;
+}
+
+/* Rings with ETF offload put a timed BD in every packet; with tx_edt the
+ * other rings add one to packets that carry an EDT timestamp.  Either way
+ * reserve room for it.
+ */
+void bnxt_set_txr_txtime(struct bnxt *bp)
 {
 	int i;
 	struct bnxt_tx_ring_info *txr;
@@ -8009,8 +8944,9 @@ static void bnxt_set_txr_etf_bmap(struct bnxt *bp)
 		for (i = 0; i < bp->tx_nr_rings; i++) {
 			txr =  &bp->tx_ring[bp->tx_ring_map[i]];
 			txr->etf_enabled = test_bit(i, bp->etf_tx_ring_map);
-			if (txr->etf_enabled)
-				txr->bd_base_cnt = BNXT_TX_BD_LONG_CNT + 1;
+			txr->edt_enabled = !txr->etf_enabled && bp->tx_edt;
+			txr->bd_base_cnt = BNXT_TX_BD_LONG_CNT +
+				(txr->etf_enabled || txr->edt_enabled);
 		}
 	}
 }
@@ -8155,12 +9091,20 @@ int bnxt_hwrm_vnic_set_hds(struct bnxt *bp, struct bnxt_vnic_info *vnic)
 	if (BNXT_RX_PAGE_MODE(bp)) {
 		req->jumbo_thresh = cpu_to_le16(bp->rx_buf_use_size);
 	} else {
-		req->flags |= cpu_to_le32(VNIC_PLCMODES_CFG_REQ_FLAGS_HDS_IPV4 |
-					  VNIC_PLCMODES_CFG_REQ_FLAGS_HDS_IPV6);
-		req->enables |=
-			cpu_to_le32(VNIC_PLCMODES_CFG_REQ_ENABLES_HDS_THRESHOLD_VALID);
+		/* Split headers from the payload of packets longer than
+		 * hds_thresh.  The payload starts at offset 0 of an
+		 * aggregation buffer, so it is page aligned and can be
+		 * remapped by TCP_ZEROCOPY_RECEIVE.
+		 */
+		if (BNXT_HDS_ACTIVE(bp)) {
+			req->flags |=
+				cpu_to_le32(VNIC_PLCMODES_CFG_REQ_FLAGS_HDS_IPV4 |
+					    VNIC_PLCMODES_CFG_REQ_FLAGS_HDS_IPV6);
+			req->enables |=
+				cpu_to_le32(VNIC_PLCMODES_CFG_REQ_ENABLES_HDS_THRESHOLD_VALID);
+			req->hds_threshold = cpu_to_le16(bp->hds_thresh);
+		}
 		req->jumbo_thresh = cpu_to_le16(bp->rx_copy_thresh);
-		req->hds_threshold = cpu_to_le16(bp->rx_copy_thresh);
 	}
 	req->vnic_id = cpu_to_le32(vnic->fw_vnic_id);
 	return hwrm_req_send(bp, req);
@@ -8505,9 +9449,11 @@ static void bnxt_set_rx_ring_params_p5(struct bnxt *bp, u32 ring_type,
 		      RING_ALLOC_REQ_ENABLES_NQ_RING_ID_VALID;
 
 	if (ring_type == HWRM_RING_ALLOC_AGG) {
+		struct bnxt_rx_ring_info *rxr = &bp->rx_ring[ring->grp_idx];
+
 		req->ring_type = RING_ALLOC_REQ_RING_TYPE_RX_AGG;
 		req->rx_ring_id = cpu_to_le16(grp_info->rx_fw_ring_id);
-		req->rx_buf_size = cpu_to_le16(BNXT_RX_PAGE_SIZE);
+		req->rx_buf_size = cpu_to_le16(bnxt_rx_agg_buf_size(bp, rxr));
 		enables |= RING_ALLOC_REQ_ENABLES_RX_RING_ID_VALID;
 	} else {
 		req->rx_buf_size = cpu_to_le16(bp->rx_buf_use_size);
@@ -8846,6 +9792,24 @@ int bnxt_hwrm_rx_ring_alloc(struct bnxt *bp, struct bnxt_rx_ring_info *rxr,
 	return 0;
 }
 
+static int bnxt_hwrm_rx_agg_ring_alloc(struct bnxt *bp,
+				       struct bnxt_rx_ring_info *rxr)
+{
+	struct bnxt_ring_struct *ring = &rxr->rx_agg_ring_struct;
+	u32 type = HWRM_RING_ALLOC_AGG;
+	u32 grp_idx = ring->grp_idx;
+	u32 map_idx;
+	int rc;
+
+	map_idx = grp_idx + bp->rx_nr_rings;
+	rc = hwrm_ring_alloc_send_msg(bp, ring, type, map_idx);
+	if (rc)
+		return rc;
+	bnxt_set_db(bp, &rxr->rx_agg_db, type, map_idx, ring->fw_ring_id);
+	bp->grp_info[grp_idx].agg_fw_ring_id = ring->fw_ring_id;
+	return 0;
+}
+
 static int bnxt_hwrm_ring_alloc(struct bnxt *bp)
 {
 	bool agg_rings = !!(bp->flags & BNXT_FLAG_AGG_RINGS);
@@ -8923,23 +9887,14 @@ static int bnxt_hwrm_ring_alloc(struct bnxt *bp)
 	}
 
 	if (agg_rings) {
-		type = HWRM_RING_ALLOC_AGG;
 		for (i = 0; i < bp->rx_nr_rings; i++) {
 			struct bnxt_rx_ring_info *rxr = &bp->rx_ring[i];
-			struct bnxt_ring_struct *ring =
-						&rxr->rx_agg_ring_struct;
-			u32 grp_idx = ring->grp_idx;
-			u32 map_idx = grp_idx + bp->rx_nr_rings;
 
-			rc = hwrm_ring_alloc_send_msg(bp, ring, type, map_idx);
+			rc = bnxt_hwrm_rx_agg_ring_alloc(bp, rxr);
 			if (rc)
 				goto err_out;
-
-			bnxt_set_db(bp, &rxr->rx_agg_db, type, map_idx,
-				    ring->fw_ring_id);
 			bnxt_db_write(bp, &rxr->rx_agg_db, rxr->rx_agg_prod);
 			bnxt_db_write(bp, &rxr->rx_db, rxr->rx_prod);
-			bp->grp_info[grp_idx].agg_fw_ring_id = ring->fw_ring_id;
 #ifdef DEV_NETMAP
 			if (BNXT_CHIP_P5_PLUS(bp)) {
 				rxr->netmap_idx = i * (2 + AGG_NM_RINGS);
@@ -9035,6 +9990,32 @@ void bnxt_hwrm_rx_ring_free(struct bnxt *bp, struct bnxt_rx_ring_info *rxr,
 	bp->grp_info[grp_idx].rx_fw_ring_id = INVALID_HW_RING_ID;
 }
 
+static void bnxt_hwrm_rx_agg_ring_free(struct bnxt *bp,
+				       struct bnxt_rx_ring_info *rxr,
+				       bool close_path)
+{
+	struct bnxt_ring_struct *ring = &rxr->rx_agg_ring_struct;
+	u32 grp_idx = rxr->bnapi->index;
+	u32 type, cmpl_ring_id;
+
+	if (ring->fw_ring_id == INVALID_HW_RING_ID)
+		return;
+
+	if (bp->flags & BNXT_FLAG_CHIP_P5_PLUS)
+		type = RING_FREE_REQ_RING_TYPE_RX_AGG;
+	else
+		type = RING_FREE_REQ_RING_TYPE_RX;
+	cmpl_ring_id = bnxt_cp_ring_for_rx(bp, rxr);
+#ifdef DEV_NETMAP
+	if (rxr->rx_cpr->netmapped)
+		cmpl_ring_id = INVALID_HW_RING_ID;
+#endif
+	hwrm_ring_free_send_msg(bp, ring, type,
+				close_path ? cmpl_ring_id : INVALID_HW_RING_ID);
+	ring->fw_ring_id = INVALID_HW_RING_ID;
+	bp->grp_info[grp_idx].agg_fw_ring_id = INVALID_HW_RING_ID;
+}
+
 static void bnxt_hwrm_ring_free(struct bnxt *bp, bool close_path)
 {
 	u32 type;
@@ -9053,30 +10034,8 @@ static void bnxt_hwrm_ring_free(struct bnxt *bp, bool close_path)
 	for (i = 0; i < bp->rx_nr_rings; i++)
 		bnxt_hwrm_rx_ring_free(bp, &bp->rx_ring[i], close_path);
 
-	if (bp->flags & BNXT_FLAG_CHIP_P5_PLUS)
-		type = RING_FREE_REQ_RING_TYPE_RX_AGG;
-	else
-		type = RING_FREE_REQ_RING_TYPE_RX;
-	for (i = 0; i < bp->rx_nr_rings; i++) {
-		struct bnxt_rx_ring_info *rxr = &bp->rx_ring[i];
-		struct bnxt_ring_struct *ring = &rxr->rx_agg_ring_struct;
-		u32 grp_idx = rxr->bnapi->index;
-
-		if (ring->fw_ring_id != INVALID_HW_RING_ID) {
-			u32 cmpl_ring_id = bnxt_cp_ring_for_rx(bp, rxr);
-
-#ifdef DEV_NETMAP
-		if (rxr->rx_cpr->netmapped)
-			cmpl_ring_id = INVALID_HW_RING_ID;
-#endif
-			hwrm_ring_free_send_msg(bp, ring, type,
-						close_path ? cmpl_ring_id :
-						INVALID_HW_RING_ID);
-			ring->fw_ring_id = INVALID_HW_RING_ID;
-			bp->grp_info[grp_idx].agg_fw_ring_id =
-				INVALID_HW_RING_ID;
-		}
-	}
+	for (i = 0; i < bp->rx_nr_rings; i++)
+		bnxt_hwrm_rx_agg_ring_free(bp, &bp->rx_ring[i], close_path);
 
 	/* The completion rings are about to be freed.  After that the
 	 * IRQ doorbell will not work anymore.  So we need to disable
@@ -9921,6 +10880,33 @@ bnxt_hwrm_set_tx_coal(struct bnxt *bp, struct bnxt_napi *bnapi,
 	return 0;
 }
 
+int bnxt_hwrm_set_ring_tx_coal(struct bnxt *bp, struct bnxt_napi *bnapi)
+{
+	struct hwrm_ring_cmpl_ring_cfg_aggint_params_input *req_tx;
+	struct bnxt_cp_ring_info *cpr = &bnapi->cp_ring;
+	struct bnxt_coal coal;
+	int rc;
+
+	if (!BNXT_NAPI_TX_COAL(bp, bnapi))
+		return -ENODEV;
+
+	memcpy(&coal, &bp->tx_coal, sizeof(struct bnxt_coal));
+
+	coal.coal_ticks = cpr->tx_ring_coal.coal_ticks;
+	coal.coal_bufs = cpr->tx_ring_coal.coal_bufs;
+
+	rc = hwrm_req_init(bp, req_tx, HWRM_RING_CMPL_RING_CFG_AGGINT_PARAMS);
+	if (rc)
+		return rc;
+
+	bnxt_hwrm_set_coal_params(bp, &coal, req_tx);
+
+	hwrm_req_hold(bp, req_tx);
+	rc = bnxt_hwrm_set_tx_coal(bp, bnapi, req_tx);
+	hwrm_req_drop(bp, req_tx);
+	return rc;
+}
+
 int bnxt_hwrm_set_coal(struct bnxt *bp)
 {
 	struct hwrm_ring_cmpl_ring_cfg_aggint_params_input *req_rx, *req_tx;
@@ -9943,7 +10929,6 @@ int bnxt_hwrm_set_coal(struct bnxt *bp)
 	hwrm_req_hold(bp, req_tx);
 	for (i = 0; i < bp->cp_nr_rings; i++) {
 		struct bnxt_napi *bnapi = bp->bnapi[i];
-		struct bnxt_cp_ring_info *cpr;
 		struct bnxt_coal *hw_coal;
 
 		if (!bnapi->rx_ring)
@@ -9953,9 +10938,7 @@ int bnxt_hwrm_set_coal(struct bnxt *bp)
 		if (rc)
 			break;
 
-		cpr = &bnapi->cp_ring;
-		cpr->rx_ring_coal.coal_ticks = bp->rx_coal.coal_ticks;
-		cpr->rx_ring_coal.coal_bufs = bp->rx_coal.coal_bufs;
+		bnxt_init_napi_coal(bp, bnapi);
 
 		if (!(bp->flags & BNXT_FLAG_CHIP_P5_PLUS))
 			continue;
@@ -9973,6 +10956,48 @@ int bnxt_hwrm_set_coal(struct bnxt *bp)
 	}
 	hwrm_req_drop(bp, req_rx);
 	hwrm_req_drop(bp, req_tx);
+
+	/* Queues with their own settings are programmed on top */
+	for (i = 0; !rc && i < bp->cp_nr_rings; i++) {
+		struct bnxt_napi *bnapi = bp->bnapi[i];
+
+		if (bnxt_napi_rx_queue_coal(bp, bnapi))
+			rc = bnxt_hwrm_set_ring_coal(bp, bnapi);
+		if (!rc && bnxt_napi_tx_queue_coal(bp, bnapi))
+			rc = bnxt_hwrm_set_ring_tx_coal(bp, bnapi);
+	}
+	return rc;
+}
+
+/* Apply a change to the per queue settings of a running NAPI */
+int bnxt_update_napi_coal(struct bnxt *bp, struct bnxt_napi *bnapi)
+{
+	struct bnxt_cp_ring_info *cpr = &bnapi->cp_ring;
+	bool rx_dim_off, tx_dim_off;
+	int rc = 0;
+
+	rx_dim_off = cpr->rx_dim_en;
+	tx_dim_off = cpr->tx_dim_en;
+	bnxt_init_napi_coal(bp, bnapi);
+	rx_dim_off &= !cpr->rx_dim_en;
+	tx_dim_off &= !cpr->tx_dim_en;
+
+	/* DIM work queued before the switch would overwrite the new
+	 * settings, wait for NAPI to stop sampling and flush it.
+	 */
+	if (rx_dim_off || tx_dim_off) {
+		synchronize_net();
+		if (rx_dim_off)
+			cancel_work_sync(&cpr->dim.work);
+		if (tx_dim_off)
+			cancel_work_sync(&cpr->tx_dim.work);
+		bnxt_init_napi_coal(bp, bnapi);
+	}
+
+	if (bnapi->rx_ring)
+		rc = bnxt_hwrm_set_ring_coal(bp, bnapi);
+	if (!rc && BNXT_NAPI_TX_COAL(bp, bnapi))
+		rc = bnxt_hwrm_set_ring_tx_coal(bp, bnapi);
 	return rc;
 }
 
@@ -12633,19 +13658,103 @@ static int bnxt_set_tpa(struct bnxt *bp, bool set_tpa)
 	int rc, i;
 	u32 tpa_flags = 0;
 
-	if (set_tpa)
-		tpa_flags = bp->flags & BNXT_FLAG_TPA;
-	else if (BNXT_NO_FW_ACCESS(bp))
-		return 0;
-	for (i = 0; i < bp->nr_vnics; i++) {
-		rc = bnxt_hwrm_vnic_set_tpa(bp, &bp->vnic_info[i], tpa_flags);
-		if (rc) {
-			netdev_err(bp->dev, "hwrm vnic set tpa failure rc for vnic %d: %x\n",
-				   i, rc);
-			return rc;
+	if (set_tpa)
+		tpa_flags = bp->flags & BNXT_FLAG_TPA;
+	else if (BNXT_NO_FW_ACCESS(bp))
+		return 0;
+	for (i = 0; i < bp->nr_vnics; i++) {
+		rc = bnxt_hwrm_vnic_set_tpa(bp, &bp->vnic_info[i], tpa_flags);
+		if (rc) {
+			netdev_err(bp->dev, "hwrm vnic set tpa failure rc for vnic %d: %x\n",
+				   i, rc);
+			return rc;
+		}
+	}
+	return 0;
+}
+
+static int bnxt_hwrm_vnic_qcfg_tpa_timer(struct bnxt *bp,
+					 struct bnxt_vnic_info *vnic)
+{
+	struct hwrm_vnic_tpa_qcfg_output *resp;
+	struct hwrm_vnic_tpa_qcfg_input *req;
+	int rc;
+
+	rc = hwrm_req_init(bp, req, HWRM_VNIC_TPA_QCFG);
+	if (rc)
+		return rc;
+
+	req->vnic_id = cpu_to_le16(vnic->fw_vnic_id);
+	resp = hwrm_req_hold(bp, req);
+	rc = hwrm_req_send(bp, req);
+	if (!rc)
+		bp->tpa_timer_dflt = le32_to_cpu(resp->max_agg_timer);
+	hwrm_req_drop(bp, req);
+	return rc;
+}
+
+/* Minimum aggregations per interval before the adaptive TPA level moves */
+#define BNXT_TPA_ADAPT_MIN_AGGS		256
+
+/* Under rtnl_lock with TPA enabled.  Step the TPA level from the
+ * aggregations completed since the last run.  If most aggregations are
+ * closed by the segment limit, the limit is holding back bulk flows and
+ * the level goes down.  If aggregations average under two segments, the
+ * traffic is request/response style and waiting for more segments only
+ * adds latency, so the level goes up.
+ */
+static void bnxt_tpa_adapt(struct bnxt *bp)
+{
+	u64 aggs = 0, segs = 0, max_ends = 0, d_aggs, d_segs, d_max_ends;
+	u8 lvl = bp->tpa_adapt_lvl;
+	int i;
+
+	if (!bp->rx_ring)
+		return;
+
+	for (i = 0; i < bp->rx_nr_rings; i++) {
+		struct bnxt_cp_ring_info *cpr = bp->rx_ring[i].rx_cpr;
+		struct bnxt_rx_sw_stats *sw_stats;
+
+		if (!cpr || !cpr->sw_stats)
+			continue;
+		sw_stats = &cpr->sw_stats->rx;
+		aggs += sw_stats->rx_tpa_max_segs_end +
+			sw_stats->rx_tpa_early_end;
+		segs += sw_stats->rx_tpa_segs;
+		max_ends += sw_stats->rx_tpa_max_segs_end;
+	}
+	d_aggs = aggs - bp->tpa_adapt_aggs;
+	d_segs = segs - bp->tpa_adapt_segs;
+	d_max_ends = max_ends - bp->tpa_adapt_max_ends;
+	/* ring stats start from zero again after a reopen */
+	if (aggs < bp->tpa_adapt_aggs || segs < bp->tpa_adapt_segs)
+		d_aggs = 0;
+	bp->tpa_adapt_aggs = aggs;
+	bp->tpa_adapt_segs = segs;
+	bp->tpa_adapt_max_ends = max_ends;
+
+	if (!bp->tpa_adapt) {
+		lvl = 0;
+	} else {
+		if (d_aggs < BNXT_TPA_ADAPT_MIN_AGGS)
+			return;
+		if (d_max_ends * 2 > d_aggs) {
+			if (lvl)
+				lvl--;
+		} else if (d_segs < d_aggs * 2) {
+			if (lvl < BNXT_TPA_ADAPT_LVL_MAX)
+				lvl++;
 		}
 	}
-	return 0;
+	if (lvl == bp->tpa_adapt_lvl)
+		return;
+
+	if (!bp->tpa_timer_dflt)
+		bnxt_hwrm_vnic_qcfg_tpa_timer(bp,
+					      &bp->vnic_info[BNXT_VNIC_DEFAULT]);
+	bp->tpa_adapt_lvl = lvl;
+	bnxt_set_tpa(bp, true);
 }
 
 static void bnxt_hwrm_clear_vnic_rss(struct bnxt *bp)
@@ -13682,7 +14791,7 @@ static void bnxt_del_napi(struct bnxt *bp)
 	for (i = 0; i < bp->cp_nr_rings; i++) {
 		struct bnxt_napi *bnapi = bp->bnapi[i];
 
-		__netif_napi_del(&bnapi->napi);
+		bnxt_netif_napi_del(&bnapi->napi);
 	}
 	/* We called __netif_napi_del(), we need
 	 * to respect an RCU grace period before freeing napi structures.
@@ -13703,12 +14812,12 @@ static void bnxt_init_napi(struct bnxt *bp)
 		cp_nr_rings--;
 	for (i = 0; i < cp_nr_rings; i++) {
 		bnapi = bp->bnapi[i];
-		___netif_napi_add(bp->dev, &bnapi->napi, poll_fn);
+		bnxt_netif_napi_add(bp->dev, &bnapi->napi, poll_fn);
 		napi_hash_add(&bnapi->napi);
 	}
 	if (BNXT_CHIP_TYPE_NITRO_A0(bp)) {
 		bnapi = bp->bnapi[cp_nr_rings];
-		___netif_napi_add(bp->dev, &bnapi->napi, bnxt_poll_nitroa0);
+		bnxt_netif_napi_add(bp->dev, &bnapi->napi, bnxt_poll_nitroa0);
 		napi_hash_add(&bnapi->napi);
 	}
 }
@@ -13724,10 +14833,12 @@ static void bnxt_disable_napi(struct bnxt *bp)
 	for (i = 0; i < bp->cp_nr_rings; i++) {
 		struct bnxt_cp_ring_info *cpr = &bp->bnapi[i]->cp_ring;
 
-		napi_disable(&bp->bnapi[i]->napi);
+		bnxt_napi_disable(&bp->bnapi[i]->napi);
 		bnxt_disable_poll(bp->bnapi[i]);
 		if (bp->bnapi[i]->rx_ring)
 			cancel_work_sync(&cpr->dim.work);
+		if (BNXT_NAPI_TX_COAL(bp, bp->bnapi[i]))
+			cancel_work_sync(&cpr->tx_dim.work);
 	}
 }
 
@@ -13750,8 +14861,12 @@ static void bnxt_enable_napi(struct bnxt *bp)
 			INIT_WORK(&cpr->dim.work, bnxt_dim_work);
 			cpr->dim.mode = DIM_CQ_PERIOD_MODE_START_FROM_EQE;
 		}
+		if (BNXT_NAPI_TX_COAL(bp, bnapi)) {
+			INIT_WORK(&cpr->tx_dim.work, bnxt_tx_dim_work);
+			cpr->tx_dim.mode = DIM_CQ_PERIOD_MODE_START_FROM_EQE;
+		}
 		bnxt_enable_poll(bnapi);
-		napi_enable(&bnapi->napi);
+		bnxt_napi_enable(&bnapi->napi);
 	}
 }
 
@@ -15014,7 +16129,7 @@ static int __bnxt_open_nic(struct bnxt *bp, bool irq_re_init, bool link_re_init)
 		netdev_warn(bp->dev, "NIC flow support will not be available\n");
 
 #if defined(HAVE_ETF_QOPT_OFFLOAD)
-	bnxt_set_txr_etf_bmap(bp);
+	bnxt_set_txr_txtime(bp);
 #endif
 	return 0;
 
@@ -15039,7 +16154,7 @@ int bnxt_open_nic(struct bnxt *bp, bool irq_re_init, bool link_re_init)
 		rc = __bnxt_open_nic(bp, irq_re_init, link_re_init);
 	if (rc) {
 		netdev_err(bp->dev, "nic open fail (rc: %x)\n", rc);
-		dev_close(bp->dev);
+		bnxt_dev_close(bp->dev);
 	}
 	return rc;
 }
@@ -15078,7 +16193,7 @@ int bnxt_half_open_nic(struct bnxt *bp)
 half_open_err:
 	bnxt_free_skbs(bp);
 	bnxt_free_mem(bp, true);
-	dev_close(bp->dev);
+	bnxt_dev_close(bp->dev);
 	return rc;
 }
 
@@ -16772,6 +17887,12 @@ static void bnxt_timer(unsigned long data)
 		queue_work = true;
 	}
 
+	if ((bp->tpa_adapt || bp->tpa_adapt_lvl) &&
+	    (bp->flags & BNXT_FLAG_TPA)) {
+		set_bit(BNXT_TPA_ADAPT_SP_EVENT, &bp->sp_event);
+		queue_work = true;
+	}
+
 	if (queue_work)
 		__bnxt_queue_sp_work(bp);
 bnxt_restart_timer:
@@ -16787,11 +17908,13 @@ static void bnxt_rtnl_lock_sp(struct bnxt *bp)
 	 */
 	clear_bit(BNXT_STATE_IN_SP_TASK, &bp->state);
 	rtnl_lock();
+	bnxt_netdev_lock(bp->dev);
 }
 
 static void bnxt_rtnl_unlock_sp(struct bnxt *bp)
 {
 	set_bit(BNXT_STATE_IN_SP_TASK, &bp->state);
+	bnxt_netdev_unlock(bp->dev);
 	rtnl_unlock();
 }
 
@@ -16823,6 +17946,16 @@ static void bnxt_reset(struct bnxt *bp, bool silent)
 	bnxt_rtnl_unlock_sp(bp);
 }
 
+/* Only called from bnxt_sp_task() */
+static void bnxt_tpa_adapt_sp(struct bnxt *bp)
+{
+	bnxt_rtnl_lock_sp(bp);
+	if (test_bit(BNXT_STATE_OPEN, &bp->state) &&
+	    (bp->flags & BNXT_FLAG_TPA))
+		bnxt_tpa_adapt(bp);
+	bnxt_rtnl_unlock_sp(bp);
+}
+
 /* Only called from bnxt_sp_task() */
 static void bnxt_rx_ring_reset(struct bnxt *bp)
 {
@@ -16854,13 +17987,13 @@ static void bnxt_rx_ring_reset(struct bnxt *bp)
 			bnxt_reset_task(bp, true);
 			break;
 		}
-		bnxt_free_one_rx_ring_skbs(bp, i);
+		bnxt_free_one_rx_ring_skbs(bp, rxr);
 		rxr->rx_prod = 0;
 		rxr->rx_agg_prod = 0;
 		rxr->rx_sw_agg_prod = 0;
 		rxr->rx_next_cons = 0;
 		rxr->bnapi->in_reset = false;
-		bnxt_alloc_one_rx_ring(bp, i);
+		bnxt_alloc_one_rx_ring(bp, rxr, i);
 		cpr = &rxr->bnapi->cp_ring;
 		cpr->sw_stats->rx.rx_resets++;
 		if (bp->flags & BNXT_FLAG_AGG_RINGS)
@@ -16872,6 +18005,393 @@ static void bnxt_rx_ring_reset(struct bnxt *bp)
 	bnxt_rtnl_unlock_sp(bp);
 }
 
+/* Per-queue RX restart.  The replacement ring memory is allocated and
+ * filled while the queue is still running, the queue is then quiesced
+ * and its hardware rings freed, and the new memory is swapped in before
+ * the hardware rings are allocated again.  The completion ring, the
+ * IRQ and the other queues are left untouched.
+ */
+static void bnxt_rx_queue_init_rmem(struct bnxt_rx_ring_info *rxr)
+{
+	struct bnxt_ring_mem_info *rmem;
+
+	rmem = &rxr->rx_ring_struct.ring_mem;
+	rmem->pg_arr = (void **)rxr->rx_desc_ring;
+	rmem->dma_arr = rxr->rx_desc_mapping;
+	rmem->vmem = (void **)&rxr->rx_buf_ring;
+
+	rmem = &rxr->rx_agg_ring_struct.ring_mem;
+	rmem->pg_arr = (void **)rxr->rx_agg_desc_ring;
+	rmem->dma_arr = rxr->rx_agg_desc_mapping;
+	rmem->vmem = (void **)&rxr->rx_agg_ring;
+}
+
+static void bnxt_rx_queue_clone_init(struct bnxt_rx_ring_info *clone)
+{
+	memset(clone->rx_desc_ring, 0, sizeof(clone->rx_desc_ring));
+	memset(clone->rx_agg_desc_ring, 0, sizeof(clone->rx_agg_desc_ring));
+	clone->rx_ring_struct.ring_mem.pg_tbl = NULL;
+	clone->rx_agg_ring_struct.ring_mem.pg_tbl = NULL;
+	bnxt_rx_queue_init_rmem(clone);
+
+	clone->rx_buf_ring = NULL;
+	clone->rx_agg_ring = NULL;
+	clone->rx_agg_bmap = NULL;
+	clone->rx_page = NULL;
+	clone->rx_page_offset = 0;
+	clone->rx_tpa = NULL;
+	clone->rx_tpa_idx_map = NULL;
+#ifdef CONFIG_PAGE_POOL
+	clone->page_pool = NULL;
+	clone->head_pool = NULL;
+#endif
+#ifdef HAVE_XDP_RXQ_INFO
+	memset(&clone->xdp_rxq, 0, sizeof(clone->xdp_rxq));
+#endif
+	clone->rx_prod = 0;
+	clone->rx_agg_prod = 0;
+	clone->rx_sw_agg_prod = 0;
+	clone->rx_next_cons = 0;
+}
+
+static void bnxt_rx_ring_mem_move(struct bnxt_rx_ring_info *dst,
+				  struct bnxt_rx_ring_info *src)
+{
+	struct bnxt_ring_mem_info *drmem, *srmem;
+
+	memcpy(dst->rx_desc_ring, src->rx_desc_ring,
+	       sizeof(src->rx_desc_ring));
+	memcpy(dst->rx_desc_mapping, src->rx_desc_mapping,
+	       sizeof(src->rx_desc_mapping));
+	memcpy(dst->rx_agg_desc_ring, src->rx_agg_desc_ring,
+	       sizeof(src->rx_agg_desc_ring));
+	memcpy(dst->rx_agg_desc_mapping, src->rx_agg_desc_mapping,
+	       sizeof(src->rx_agg_desc_mapping));
+
+	drmem = &dst->rx_ring_struct.ring_mem;
+	srmem = &src->rx_ring_struct.ring_mem;
+	drmem->pg_tbl = srmem->pg_tbl;
+	drmem->pg_tbl_map = srmem->pg_tbl_map;
+
+	drmem = &dst->rx_agg_ring_struct.ring_mem;
+	srmem = &src->rx_agg_ring_struct.ring_mem;
+	drmem->pg_tbl = srmem->pg_tbl;
+	drmem->pg_tbl_map = srmem->pg_tbl_map;
+
+	dst->rx_buf_ring = src->rx_buf_ring;
+	dst->rx_agg_ring = src->rx_agg_ring;
+	dst->rx_agg_bmap = src->rx_agg_bmap;
+	dst->rx_agg_bmap_size = src->rx_agg_bmap_size;
+	dst->rx_page = src->rx_page;
+	dst->rx_page_offset = src->rx_page_offset;
+	dst->rx_tpa = src->rx_tpa;
+	dst->rx_tpa_idx_map = src->rx_tpa_idx_map;
+#ifdef CONFIG_PAGE_POOL
+	dst->page_pool = src->page_pool;
+	dst->head_pool = src->head_pool;
+#endif
+#ifdef HAVE_XDP_RXQ_INFO
+	dst->xdp_rxq = src->xdp_rxq;
+#endif
+	dst->xsk_pool = src->xsk_pool;
+	dst->flags = src->flags;
+
+	dst->rx_prod = src->rx_prod;
+	dst->rx_agg_prod = src->rx_agg_prod;
+	dst->rx_sw_agg_prod = src->rx_sw_agg_prod;
+	dst->rx_next_cons = src->rx_next_cons;
+}
+
+static void bnxt_rx_queue_mem_free(struct bnxt *bp,
+				   struct bnxt_rx_ring_info *clone)
+{
+	bnxt_free_one_rx_ring_skbs(bp, clone);
+	bnxt_free_one_tpa_info(bp, clone);
+#ifdef HAVE_XDP_RXQ_INFO
+	if (xdp_rxq_info_is_reg(&clone->xdp_rxq))
+		xdp_rxq_info_unreg(&clone->xdp_rxq);
+#endif
+#ifdef CONFIG_PAGE_POOL
+	page_pool_destroy(clone->head_pool);
+	clone->head_pool = NULL;
+	page_pool_destroy(clone->page_pool);
+	clone->page_pool = NULL;
+#endif
+	kfree(clone->rx_agg_bmap);
+	clone->rx_agg_bmap = NULL;
+	bnxt_free_ring(bp, &clone->rx_ring_struct.ring_mem);
+	bnxt_free_ring(bp, &clone->rx_agg_ring_struct.ring_mem);
+}
+
+static int bnxt_rx_queue_mem_alloc(struct bnxt *bp,
+				   struct bnxt_rx_ring_info *clone, int idx)
+{
+	struct bnxt_rx_ring_info *rxr = &bp->rx_ring[idx];
+	int numa_node = dev_to_node(&bp->pdev->dev);
+	bool tpa = !!rxr->rx_tpa;
+	int rc;
+
+	if (!(bp->flags & BNXT_FLAG_CHIP_P5_PLUS))
+		return -EOPNOTSUPP;
+
+	memcpy(clone, rxr, sizeof(*clone));
+	bnxt_rx_queue_clone_init(clone);
+
+	numa_node = cpu_to_node(cpumask_local_spread(idx, numa_node));
+	rc = bnxt_alloc_rx_page_pool(bp, clone, numa_node);
+	if (rc)
+		return rc;
+
+	rc = bnxt_rx_ring_reg_xdp_rxq(bp, clone, idx);
+	if (rc)
+		goto err_free;
+
+	rc = bnxt_alloc_ring(bp, &clone->rx_ring_struct.ring_mem);
+	if (rc)
+		goto err_free;
+
+	if (bp->flags & BNXT_FLAG_AGG_RINGS) {
+		rc = bnxt_alloc_ring(bp, &clone->rx_agg_ring_struct.ring_mem);
+		if (rc)
+			goto err_free;
+
+		clone->rx_agg_bmap_size = bp->rx_agg_ring_mask + 1;
+		clone->rx_agg_bmap = kzalloc(clone->rx_agg_bmap_size / 8,
+					     GFP_KERNEL);
+		if (!clone->rx_agg_bmap) {
+			rc = -ENOMEM;
+			goto err_free;
+		}
+	}
+
+	if (tpa) {
+		rc = bnxt_alloc_one_tpa_info(bp, clone);
+		if (rc)
+			goto err_free;
+	}
+
+	bnxt_init_one_rx_ring_rxbd(bp, clone);
+	rc = bnxt_alloc_one_rx_ring(bp, clone, idx);
+	if (rc)
+		goto err_free;
+	return 0;
+
+err_free:
+	bnxt_rx_queue_mem_free(bp, clone);
+	return rc;
+}
+
+static void bnxt_rx_queue_set_mru(struct bnxt *bp, bool enable)
+{
+	int i;
+
+	for (i = 0; i < bp->nr_vnics && i <= BNXT_VNIC_NTUPLE; i++) {
+		struct bnxt_vnic_info *vnic = &bp->vnic_info[i];
+
+		if (vnic->fw_vnic_id == INVALID_HW_RING_ID)
+			continue;
+		vnic->mru = enable ? bp->dev->mtu + ETH_HLEN + VLAN_HLEN : 0;
+		bnxt_hwrm_vnic_update(bp, vnic,
+				      VNIC_UPDATE_REQ_ENABLES_MRU_VALID);
+	}
+}
+
+/* Steer RX traffic away from ring @idx, or back to it.  The ring's RSS
+ * table entries in every VNIC and RSS context point at the next ring
+ * while it is swapped, so the other queues keep running.  Ring 0 is
+ * also the VNIC default ring for unhashed traffic and a single ring has
+ * nowhere to go, so those still stop all RX with a zero MRU.
+ */
+static void bnxt_rx_queue_steer(struct bnxt *bp, int idx, bool enable)
+{
+	struct bnxt_rss_ctx *rss_ctx;
+	int i;
+
+	if (!idx || bp->rx_nr_rings < 2) {
+		bnxt_rx_queue_set_mru(bp, enable);
+		return;
+	}
+
+	bp->rss_skip_ring = enable ? 0 : idx;
+	for (i = 0; i < bp->nr_vnics && i <= BNXT_VNIC_NTUPLE; i++) {
+		struct bnxt_vnic_info *vnic = &bp->vnic_info[i];
+
+		if (vnic->fw_vnic_id == INVALID_HW_RING_ID)
+			continue;
+		bnxt_hwrm_vnic_set_rss_p5(bp, vnic, true);
+	}
+	if (!(bp->rss_cap & BNXT_RSS_CAP_MULTI_RSS_CTX))
+		return;
+	list_for_each_entry(rss_ctx, &bp->rss_ctx_list, list)
+		bnxt_hwrm_vnic_set_rss_p5(bp, &rss_ctx->vnic, true);
+}
+
+static void bnxt_rx_queue_stop(struct bnxt *bp,
+			       struct bnxt_rx_ring_info *old, int idx)
+{
+	struct bnxt_rx_ring_info *rxr = &bp->rx_ring[idx];
+	struct bnxt_napi *bnapi = rxr->bnapi;
+
+	/* Stop the VNICs from steering new packets to the ring, then
+	 * free the hardware rings through the completion ring so that
+	 * NAPI has consumed every completion that refers to them.
+	 */
+	bnxt_rx_queue_steer(bp, idx, false);
+	synchronize_net();
+	bnxt_hwrm_rx_ring_free(bp, rxr, true);
+	bnxt_hwrm_rx_agg_ring_free(bp, rxr, true);
+#if defined(CONFIG_PAGE_POOL) && defined(HAVE_PAGE_POOL_DISABLE_DIRECT)
+	page_pool_disable_direct_recycling(rxr->page_pool);
+	if (rxr->head_pool)
+		page_pool_disable_direct_recycling(rxr->head_pool);
+#endif
+	bnxt_napi_disable(&bnapi->napi);
+
+	memcpy(old, rxr, sizeof(*old));
+	bnxt_rx_queue_init_rmem(old);
+}
+
+static int bnxt_rx_queue_start(struct bnxt *bp,
+			       struct bnxt_rx_ring_info *mem, int idx)
+{
+	struct bnxt_rx_ring_info *rxr = &bp->rx_ring[idx];
+	int rc;
+
+	bnxt_rx_ring_mem_move(rxr, mem);
+#if defined(HAVE_XSK_SUPPORT) && defined(HAVE_XDP_RXQ_INFO)
+	if (BNXT_RING_RX_ZC_MODE(rxr) && rxr->xsk_pool)
+		xsk_pool_set_rxq_info(rxr->xsk_pool, &rxr->xdp_rxq);
+#endif
+
+	rc = bnxt_hwrm_rx_ring_alloc(bp, rxr, idx);
+	if (rc)
+		return rc;
+	if (bp->flags & BNXT_FLAG_AGG_RINGS) {
+		rc = bnxt_hwrm_rx_agg_ring_alloc(bp, rxr);
+		if (rc) {
+			bnxt_hwrm_rx_ring_free(bp, rxr, false);
+			return rc;
+		}
+		bnxt_db_write(bp, &rxr->rx_agg_db, rxr->rx_agg_prod);
+	}
+	bnxt_db_write(bp, &rxr->rx_db, rxr->rx_prod);
+	return 0;
+}
+
+/**
+ * bnxt_restart_rx_queue - rebuild one RX queue without a full reopen
+ * @bp: the driver context
+ * @idx: RX ring index
+ *
+ * Allocates and fills fresh ring memory for the queue, then swaps it in
+ * with only that queue briefly stopped.  This is used to re-pool a queue
+ * for AF_XDP and, through the queue management ops, for memory providers.
+ * ethtool -G/-L and feature changes resize the rings and the completion
+ * rings shared with TX, so they still go through a full close and open.
+ * Must be called with rtnl and the netdev instance lock held while the
+ * device is open.
+ *
+ * Returns 0 on success, or a negative error code.
+ */
+int bnxt_restart_rx_queue(struct bnxt *bp, int idx)
+{
+	struct bnxt_rx_ring_info *rxr, *new, *old;
+	int rc;
+
+	if (idx >= bp->rx_nr_rings)
+		return -EINVAL;
+
+	new = kzalloc(sizeof(*new), GFP_KERNEL);
+	old = kzalloc(sizeof(*old), GFP_KERNEL);
+	if (!new || !old) {
+		rc = -ENOMEM;
+		goto out;
+	}
+
+	rc = bnxt_rx_queue_mem_alloc(bp, new, idx);
+	if (rc)
+		goto out;
+
+	rxr = &bp->rx_ring[idx];
+	bnxt_rx_queue_stop(bp, old, idx);
+	rc = bnxt_rx_queue_start(bp, new, idx);
+	if (rc) {
+		netdev_err(bp->dev, "RX queue %d restart failed, rc = %d, restoring previous buffers\n",
+			   idx, rc);
+		bnxt_rx_ring_mem_move(new, rxr);
+		if (bnxt_rx_queue_start(bp, old, idx)) {
+			/* Keep the old memory attached to the ring and let
+			 * the reset task rebuild the device.
+			 */
+			bnxt_queue_sp_work(bp, BNXT_RESET_TASK_SP_EVENT);
+			bnxt_rx_queue_mem_free(bp, new);
+			goto out_enable;
+		}
+		swap(new, old);
+	} else {
+		rxr->bnapi->cp_ring.sw_stats->rx.rx_queue_restarts++;
+	}
+	bnxt_rx_queue_mem_free(bp, old);
+
+out_enable:
+	bnxt_napi_enable(&rxr->bnapi->napi);
+	bnxt_rx_queue_steer(bp, idx, true);
+out:
+	kfree(new);
+	kfree(old);
+	return rc;
+}
+
+#ifdef HAVE_NETDEV_QMGMT_OPS
+static int bnxt_queue_mem_alloc(struct net_device *dev, void *qmem, int idx)
+{
+	struct bnxt *bp = netdev_priv(dev);
+
+	return bnxt_rx_queue_mem_alloc(bp, qmem, idx);
+}
+
+static void bnxt_queue_mem_free(struct net_device *dev, void *qmem)
+{
+	struct bnxt *bp = netdev_priv(dev);
+
+	bnxt_rx_queue_mem_free(bp, qmem);
+}
+
+static int bnxt_queue_start(struct net_device *dev, void *qmem, int idx)
+{
+	struct bnxt *bp = netdev_priv(dev);
+	struct bnxt_rx_ring_info *rxr = &bp->rx_ring[idx];
+	int rc;
+
+	rc = bnxt_rx_queue_start(bp, qmem, idx);
+	if (rc) {
+		/* The core frees qmem on failure, hand the memory back */
+		bnxt_rx_ring_mem_move(qmem, rxr);
+		return rc;
+	}
+	rxr->bnapi->cp_ring.sw_stats->rx.rx_queue_restarts++;
+	bnxt_napi_enable(&rxr->bnapi->napi);
+	bnxt_rx_queue_steer(bp, idx, true);
+	return 0;
+}
+
+static int bnxt_queue_stop(struct net_device *dev, void *qmem, int idx)
+{
+	struct bnxt *bp = netdev_priv(dev);
+
+	bnxt_rx_queue_stop(bp, qmem, idx);
+	return 0;
+}
+
+static const struct netdev_queue_mgmt_ops bnxt_queue_mgmt_ops = {
+	.ndo_queue_mem_size	= sizeof(struct bnxt_rx_ring_info),
+	.ndo_queue_mem_alloc	= bnxt_queue_mem_alloc,
+	.ndo_queue_mem_free	= bnxt_queue_mem_free,
+	.ndo_queue_start	= bnxt_queue_start,
+	.ndo_queue_stop		= bnxt_queue_stop,
+};
+#endif
+
 static inline void bnxt_fw_error_tf_reinit(struct bnxt *bp)
 {
 	int rc;
@@ -17048,7 +18568,7 @@ void bnxt_fw_reset(struct bnxt *bp)
 			netdev_err(bp->dev, "Firmware reset aborted, rc = %d\n",
 				   n);
 			clear_bit(BNXT_STATE_IN_FW_RESET, &bp->state);
-			dev_close(bp->dev);
+			bnxt_dev_close(bp->dev);
 			goto fw_reset_exit;
 		} else if (n > 0) {
 			u16 vf_tmo_dsecs = n * 10;
@@ -17332,6 +18852,9 @@ static void bnxt_sp_task(struct work_struct *work)
 	/* These functions below will clear BNXT_STATE_IN_SP_TASK.  They
 	 * must be the last functions to be called before exiting.
 	 */
+	if (test_and_clear_bit(BNXT_TPA_ADAPT_SP_EVENT, &bp->sp_event))
+		bnxt_tpa_adapt_sp(bp);
+
 	if (test_and_clear_bit(BNXT_RESET_TASK_SP_EVENT, &bp->sp_event))
 		bnxt_reset(bp, false);
 
@@ -17794,7 +19317,7 @@ static void bnxt_fw_reset_abort(struct bnxt *bp, int rc)
 	if (bp->fw_reset_state != BNXT_FW_RESET_STATE_POLL_VF)
 		bnxt_dl_health_fw_status_update(bp, false);
 	bp->fw_reset_state = 0;
-	dev_close(bp->dev);
+	bnxt_dev_close(bp->dev);
 }
 
 static void bnxt_fw_reset_task(struct work_struct *work)
@@ -17830,8 +19353,10 @@ static void bnxt_fw_reset_task(struct work_struct *work)
 		}
 		bp->fw_reset_timestamp = jiffies;
 		rtnl_lock();
+		bnxt_netdev_lock(bp->dev);
 		if (test_bit(BNXT_STATE_ABORT_ERR, &bp->state)) {
 			bnxt_fw_reset_abort(bp, rc);
+			bnxt_netdev_unlock(bp->dev);
 			rtnl_unlock();
 			goto ulp_start;
 		}
@@ -17844,6 +19369,7 @@ static void bnxt_fw_reset_task(struct work_struct *work)
 			tmo = bp->fw_reset_min_dsecs * HZ / 10;
 		}
 		bnxt_queue_fw_reset_work(bp, tmo);
+		bnxt_netdev_unlock(bp->dev);
 		rtnl_unlock();
 		return;
 	}
@@ -17921,10 +19447,12 @@ static void bnxt_fw_reset_task(struct work_struct *work)
 			bnxt_queue_fw_reset_work(bp, HZ / 50);
 			return;
 		}
+		bnxt_netdev_lock(bp->dev);
 		rc = bnxt_open(bp->dev);
 		if (rc) {
 			netdev_err(bp->dev, "bnxt_open() failed during FW reset\n");
 			bnxt_fw_reset_abort(bp, rc);
+			bnxt_netdev_unlock(bp->dev);
 			rtnl_unlock();
 			goto ulp_start;
 		}
@@ -17944,6 +19472,7 @@ static void bnxt_fw_reset_task(struct work_struct *work)
 			bnxt_dl_health_fw_recovery_done(bp);
 			bnxt_dl_health_fw_status_update(bp, true);
 		}
+		bnxt_netdev_unlock(bp->dev);
 		rtnl_unlock();
 		bnxt_ulp_start(bp, 0);
 		bnxt_reenable_sriov(bp);
@@ -17964,7 +19493,9 @@ fw_reset_abort_status:
 	}
 fw_reset_abort:
 	rtnl_lock();
+	bnxt_netdev_lock(bp->dev);
 	bnxt_fw_reset_abort(bp, rc);
+	bnxt_netdev_unlock(bp->dev);
 	rtnl_unlock();
 ulp_start:
 	bnxt_ulp_start(bp, rc);
@@ -18032,6 +19563,7 @@ static int bnxt_init_board(struct pci_dev *pdev, struct net_device *dev)
 	INIT_DELAYED_WORK(&bp->fw_reset_task, bnxt_fw_reset_task);
 
 	spin_lock_init(&bp->ntp_fltr_lock);
+	init_llist_head(&bp->ntp_fltr_new_list);
 #if BITS_PER_LONG == 32
 	spin_lock_init(&bp->db_lock);
 #endif
@@ -18042,6 +19574,7 @@ static int bnxt_init_board(struct pci_dev *pdev, struct net_device *dev)
 	bp->rx_ring_size = BNXT_DEFAULT_RX_RING_SIZE;
 #endif
 	bp->tx_ring_size = BNXT_DEFAULT_TX_RING_SIZE;
+	bp->hds_thresh = BNXT_RX_COPY_THRESH;
 
 #ifdef HAVE_TIMER_SETUP
 	timer_setup(&bp->timer, bnxt_timer, 0);
@@ -18202,9 +19735,7 @@ static int bnxt_setup_etf_tc(struct net_device *dev, struct tc_etf_qopt_offload
 {
 	struct bnxt *bp = netdev_priv(dev);
 
-	/* The so_txtime driver currently supports only phc RTC mode */
-	if (!BNXT_SUPPORTS_ETF(bp) || !bp->ptp_cfg ||
-	    !BNXT_PTP_USE_RTC(bp) || !bp->etf_tx_ring_map)
+	if (!bnxt_tx_edt_supported(bp))
 		return -EOPNOTSUPP;
 
 	if (qopt->queue > bp->tx_nr_rings - bp->tx_nr_rings_xdp - 1) {
@@ -18218,7 +19749,7 @@ static int bnxt_setup_etf_tc(struct net_device *dev, struct tc_etf_qopt_offload
 			__clear_bit(qopt->queue, bp->etf_tx_ring_map);
 
 	if (netif_running(bp->dev))
-		bnxt_set_txr_etf_bmap(bp);
+		bnxt_set_txr_txtime(bp);
 
 	return 0;
 }
@@ -18398,7 +19929,7 @@ u32 bnxt_get_ntp_filter_idx(struct bnxt *bp, struct flow_keys *fkeys, const stru
 	struct bnxt_vnic_info *vnic;
 
 	if (skb)
-		return skb_get_hash_raw(skb) & BNXT_NTP_FLTR_HASH_MASK;
+		return skb_get_hash_raw(skb) & bp->ntp_fltr_hash_mask;
 
 	vnic = &bp->vnic_info[BNXT_VNIC_DEFAULT];
 	return bnxt_toeplitz(bp, fkeys, (void *)vnic->rss_hash_key);
@@ -18410,6 +19941,9 @@ int bnxt_insert_ntp_filter(struct bnxt *bp, struct bnxt_ntuple_filter *fltr,
 	struct hlist_head *head;
 	int bit_id;
 
+	if (!bp->ntp_fltr_hash_tbl)
+		return -EOPNOTSUPP;
+
 	spin_lock_bh(&bp->ntp_fltr_lock);
 	bit_id = bitmap_find_free_region(bp->ntp_fltr_bmap, bp->max_fltr, 0);
 	if (bit_id < 0) {
@@ -18420,6 +19954,12 @@ int bnxt_insert_ntp_filter(struct bnxt *bp, struct bnxt_ntuple_filter *fltr,
 	fltr->base.sw_id = (u16)bit_id;
 	fltr->base.type = BNXT_FLTR_TYPE_NTUPLE;
 	fltr->base.flags |= BNXT_ACT_RING_DST;
+	if (!test_bit(BNXT_FLTR_VALID, &fltr->base.state)) {
+		fltr->queued = ktime_get();
+		set_bit(BNXT_FLTR_PENDING, &fltr->base.state);
+		atomic_inc(&bp->ntp_fltr_pending);
+		llist_add(&fltr->new_node, &bp->ntp_fltr_new_list);
+	}
 	head = &bp->ntp_fltr_hash_tbl[idx];
 	hlist_add_head_rcu(&fltr->base.hash, head);
 	set_bit(BNXT_FLTR_INSERTED, &fltr->base.state);
@@ -18451,6 +19991,15 @@ static int bnxt_rx_flow_steer(struct net_device *dev, const struct sk_buff *skb,
 		return -EPROTONOSUPPORT;
 #endif
 
+	/* Don't let the backlog of filters waiting for bnxt_sp_task()
+	 * grow without bound when flows arrive faster than they can be
+	 * programmed.
+	 */
+	if (atomic_read(&bp->ntp_fltr_pending) >= BNXT_NTP_FLTR_MAX_PENDING) {
+		atomic64_inc(&bp->ntp_fltr_counters[BNXT_NTP_FLTR_BACKLOG_DROP]);
+		return -EBUSY;
+	}
+
 	if (ether_addr_equal(dev->dev_addr, eth->h_dest)) {
 		l2_fltr = bp->vnic_info[BNXT_VNIC_DEFAULT].l2_filters[0];
 		atomic_inc(&l2_fltr->refcnt);
@@ -18537,12 +20086,66 @@ void bnxt_del_ntp_filter(struct bnxt *bp, struct bnxt_ntuple_filter *fltr)
 	hlist_del_rcu(&fltr->base.hash);
 	bnxt_del_one_usr_fltr(bp, &fltr->base);
 	bp->ntp_fltr_count--;
+	if (test_and_clear_bit(BNXT_FLTR_PENDING, &fltr->base.state))
+		atomic_dec(&bp->ntp_fltr_pending);
 	spin_unlock_bh(&bp->ntp_fltr_lock);
 	bnxt_del_l2_filter(bp, fltr->l2_fltr);
 	clear_bit(fltr->base.sw_id, bp->ntp_fltr_bmap);
 	kfree_rcu(fltr, base.rcu);
 }
 
+/* Program the aRFS filters queued by bnxt_rx_flow_steer() in arrival
+ * order, one blocking HWRM request each.
+ */
+static void bnxt_cfg_new_ntp_filters(struct bnxt *bp)
+{
+	struct bnxt_ntuple_filter *fltr, *tmp;
+	struct llist_node *list;
+
+	list = llist_del_all(&bp->ntp_fltr_new_list);
+	if (!list)
+		return;
+
+	list = llist_reverse_order(list);
+	llist_for_each_entry_safe(fltr, tmp, list, new_node) {
+		if (bnxt_ntp_fltr_install(bp, fltr))
+			bnxt_del_ntp_filter(bp, fltr);
+	}
+}
+
+static void bnxt_expire_ntp_filters(struct bnxt *bp)
+{
+#ifdef CONFIG_RFS_ACCEL
+	u32 i, idx, scan = BNXT_NTP_FLTR_EXPIRE_SCAN;
+
+	/* Only a window of the table is checked per pass so that a large
+	 * table does not stall bnxt_sp_task().
+	 */
+	scan = min_t(u32, scan, bp->ntp_fltr_hash_size);
+	idx = bp->ntp_fltr_expire_idx;
+	for (i = 0; i < scan; i++, idx = (idx + 1) & bp->ntp_fltr_hash_mask) {
+		struct hlist_head *head;
+		struct hlist_node *tmp, __maybe_unused *nxt;
+		struct bnxt_ntuple_filter *fltr;
+
+		head = &bp->ntp_fltr_hash_tbl[idx];
+		__hlist_for_each_entry_safe(fltr, nxt, tmp, head, base.hash) {
+			if (!test_bit(BNXT_FLTR_VALID, &fltr->base.state) ||
+			    (fltr->base.flags & BNXT_ACT_NO_AGING))
+				continue;
+			if (!rps_may_expire_flow(bp->dev, fltr->base.rxq,
+						 fltr->flow_id,
+						 fltr->base.sw_id))
+				continue;
+			bnxt_hwrm_cfa_ntuple_filter_free(bp, fltr);
+			atomic64_inc(&bp->ntp_fltr_counters[BNXT_NTP_FLTR_EXPIRE]);
+			bnxt_del_ntp_filter(bp, fltr);
+		}
+	}
+	bp->ntp_fltr_expire_idx = idx;
+#endif /* CONFIG_RFS_ACCEL */
+}
+
 static void bnxt_cfg_ntp_filters(struct bnxt *bp)
 {
 	int i;
@@ -18564,42 +20167,8 @@ static void bnxt_cfg_ntp_filters(struct bnxt *bp)
 			}
 		}
 	}
-	for (i = 0; i < BNXT_NTP_FLTR_HASH_SIZE; i++) {
-		struct hlist_head *head;
-		struct hlist_node *tmp, __maybe_unused *nxt;
-		struct bnxt_ntuple_filter *fltr;
-		int rc;
-
-		head = &bp->ntp_fltr_hash_tbl[i];
-		__hlist_for_each_entry_safe(fltr, nxt, tmp, head, base.hash) {
-			bool del = false;
-
-			if (test_bit(BNXT_FLTR_VALID, &fltr->base.state)) {
-				if (fltr->base.flags & BNXT_ACT_NO_AGING)
-					continue;
-#ifdef CONFIG_RFS_ACCEL
-				if (rps_may_expire_flow(bp->dev, fltr->base.rxq,
-							fltr->flow_id,
-							fltr->base.sw_id)) {
-					bnxt_hwrm_cfa_ntuple_filter_free(bp,
-									 fltr);
-					del = true;
-				}
-#endif /* CONFIG_RFS_ACCEL */
-			} else {
-				rc = bnxt_hwrm_cfa_ntuple_filter_alloc(bp,
-								       fltr);
-				if (rc)
-					del = true;
-				else
-					set_bit(BNXT_FLTR_VALID,
-						&fltr->base.state);
-			}
-
-			if (del)
-				bnxt_del_ntp_filter(bp, fltr);
-		}
-	}
+	bnxt_cfg_new_ntp_filters(bp);
+	bnxt_expire_ntp_filters(bp);
 }
 
 static void bnxt_deinit_lag(struct bnxt *bp)
@@ -19136,6 +20705,8 @@ static void bnxt_remove_one(struct pci_dev *pdev)
 	bnxt_free_udcc_info(bp);
 	kfree(bp->rss_indir_tbl);
 	bp->rss_indir_tbl = NULL;
+	kfree(bp->queue_coal);
+	bp->queue_coal = NULL;
 	bnxt_free_port_stats(bp);
 #if defined(HAVE_ETF_QOPT_OFFLOAD)
 	bnxt_free_tc_etf_bitmap(bp);
@@ -19472,7 +21043,7 @@ int bnxt_restore_pf_fw_resources(struct bnxt *bp)
 
 	if (netif_running(bp->dev)) {
 		if (rc)
-			dev_close(bp->dev);
+			bnxt_dev_close(bp->dev);
 		else
 			rc = bnxt_open_nic(bp, true, false);
 	}
@@ -20057,6 +21628,18 @@ static int bnxt_init_one(struct pci_dev *pdev, const struct pci_device_id *ent)
 	dev->xdp_features = NETDEV_XDP_ACT_BASIC | NETDEV_XDP_ACT_REDIRECT |
 			    NETDEV_XDP_ACT_RX_SG | NETDEV_XDP_ACT_XSK_ZEROCOPY;
 #endif
+#ifdef HAVE_XSK_MULTI_BUFF
+	dev->xdp_zc_max_segs = BNXT_XSK_MAX_SEGS;
+#endif
+#ifdef HAVE_XDP_METADATA_OPS
+	dev->xdp_metadata_ops = &bnxt_xdp_metadata_ops;
+#endif
+#ifdef HAVE_NETDEV_QMGMT_OPS
+	/* Registered on every chip so that the core holds the instance lock
+	 * the same way for all of them; the ops refuse pre-P5 queues.
+	 */
+	dev->queue_mgmt_ops = &bnxt_queue_mgmt_ops;
+#endif
 
 #ifdef CONFIG_BNXT_SRIOV
 	init_waitqueue_head(&bp->sriov_cfg_wait);
@@ -20237,6 +21820,8 @@ init_err_pci_clean:
 	bnxt_free_udcc_info(bp);
 	kfree(bp->rss_indir_tbl);
 	bp->rss_indir_tbl = NULL;
+	kfree(bp->queue_coal);
+	bp->queue_coal = NULL;
 
 init_err_free:
 	free_netdev(dev);
@@ -20284,7 +21869,9 @@ static int bnxt_suspend(struct device *device)
 	rtnl_lock();
 	if (netif_running(dev)) {
 		netif_device_detach(dev);
+		bnxt_netdev_lock(dev);
 		rc = bnxt_close(dev);
+		bnxt_netdev_unlock(dev);
 	}
 	bnxt_hwrm_func_drv_unrgtr(bp);
 	pci_disable_device(bp->pdev);
@@ -20331,7 +21918,9 @@ static int bnxt_resume(struct device *device)
 
 	bnxt_get_wol_settings(bp);
 	if (netif_running(dev)) {
+		bnxt_netdev_lock(dev);
 		rc = bnxt_open(dev);
+		bnxt_netdev_unlock(dev);
 		if (!rc)
 			netif_device_attach(dev);
 	}
@@ -20388,6 +21977,8 @@ static pci_ers_result_t bnxt_io_error_detected(struct pci_dev *pdev,
 		return PCI_ERS_RESULT_DISCONNECT;
 	}
 
+	bnxt_netdev_lock(netdev);
+
 	/* Link is not reliable anymore if state is pci_channel_io_frozen
 	 * so we disable bus master to prevent any potential bad DMAs before
 	 * freeing kernel memory.
@@ -20406,6 +21997,7 @@ static pci_ers_result_t bnxt_io_error_detected(struct pci_dev *pdev,
 	if (netif_running(netdev))
 		__bnxt_close_nic(bp, true, true);
 
+	bnxt_netdev_unlock(netdev);
 	rtnl_unlock();
 	bnxt_ulp_stop(bp);
 
@@ -20527,8 +22119,11 @@ static void bnxt_io_resume(struct pci_dev *pdev)
 	rtnl_lock();
 
 	err = bnxt_hwrm_func_qcaps(bp, true);
-	if (!err && netif_running(netdev))
+	if (!err && netif_running(netdev)) {
+		bnxt_netdev_lock(netdev);
 		err = bnxt_open(netdev);
+		bnxt_netdev_unlock(netdev);
+	}
 
 	if (!err)
 		netif_device_attach(netdev);
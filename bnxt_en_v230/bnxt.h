@@ -40,6 +40,9 @@
 #ifdef HAVE_XDP_RXQ_INFO
 #include <net/xdp.h>
 #endif
+#ifdef HAVE_PAGE_POOL_NETMEM
+#include <net/netmem.h>
+#endif
 #ifdef HAVE_DIM
 #include <linux/dim.h>
 #else
@@ -915,6 +918,9 @@ struct nqe_cn {
 #define BNXT_DEFAULT_RX_RING_SIZE	511
 #define BNXT_DEFAULT_TX_RING_SIZE	511
 
+/* Max RX completions prefetched by one look-ahead */
+#define BNXT_RX_PREFETCH_MAX	32
+
 #define BNXT_TSO_MAX_SEGS_P5	4096
 
 #define MAX_TPA		64
@@ -1035,6 +1041,7 @@ struct bnxt_sw_tx_bd {
 	u8			is_push;
 	u8			inline_data_bds;
 	u8			action;
+	u8			is_txtime;
 	unsigned short		nr_frags;
 	union {
 		u16			rx_prod;
@@ -1049,7 +1056,19 @@ struct bnxt_sw_rx_bd {
 };
 
 struct bnxt_sw_rx_agg_bd {
-	struct page		*page;
+	/* netmem may be an unreadable net_iov from a memory provider;
+	 * page is only valid for buffers backed by host pages.  On an
+	 * AF_XDP zero-copy ring the buffer is an xsk_buf from the pool.
+	 */
+	union {
+		struct page	*page;
+#ifdef HAVE_PAGE_POOL_NETMEM
+		netmem_ref	netmem;
+#endif
+#ifdef HAVE_XSK_MULTI_BUFF
+		struct xdp_buff	*xsk_buf;
+#endif
+	};
 	unsigned int		offset;
 	dma_addr_t		mapping;
 };
@@ -1143,7 +1162,20 @@ struct bnxt_tx_ring_info {
 	u8			kick_pending;
 	u8			bd_base_cnt;
 	u8			etf_enabled;
+	/* Honor EDT timestamps from the qdisc with a timed BD */
+	u8			edt_enabled;
+	/* Push candidates to skip after one found the ring busy */
+	u8			tx_push_backoff;
+#define BNXT_TX_PUSH_BACKOFF	16
 	u16			xdp_tx_pending;
+	/* BDs and bytes queued with NO_CMPL since the last packet that
+	 * requested a TX completion.  tx_cmpl_max_bds is written by DIM
+	 * work and read in the xmit path.
+	 */
+	u16			tx_cmpl_bds;
+	u16			tx_cmpl_max_bds;
+#define BNXT_TX_CMPL_MAX_BDS	64
+	u32			tx_cmpl_bytes;
 	struct bnxt_db_info	tx_db;
 
 	struct tx_bd		*tx_desc_ring[MAX_TX_PAGES];
@@ -1218,6 +1250,22 @@ struct bnxt_coal {
 	u16			flags;
 };
 
+/* Coalescing of one queue set with ethtool --per-queue.  It is kept
+ * across a reopen and applied on top of the global settings by
+ * bnxt_init_napi_coal().  A global set_coalesce clears it.
+ */
+struct bnxt_queue_coal {
+	u8			flags;
+#define BNXT_QUEUE_COAL_RX	0x1
+#define BNXT_QUEUE_COAL_TX	0x2
+	u8			rx_dim_en;
+	u8			tx_dim_en;
+	u16			rx_coal_ticks;
+	u16			rx_coal_bufs;
+	u16			tx_coal_ticks;
+	u16			tx_coal_bufs;
+};
+
 struct bnxt_tpa_info {
 	void			*data;
 	u8			*data_ptr;
@@ -1257,6 +1305,21 @@ struct bnxt_tpa_idx_map {
 	unsigned long	agg_idx_bmap[BNXT_AGG_IDX_BMAP_SIZE];
 };
 
+/* RX packet size histogram bin b counts packets of (32 << b, 64 << b]
+ * bytes, the last bin counts everything larger.
+ */
+#define BNXT_RX_SIZE_HIST_BINS	7
+#define BNXT_RX_SIZE_BIN_EDGE(b)	(64U << (b))
+
+/* Packets per adaptive copybreak evaluation window */
+#define BNXT_RX_COPYBREAK_WIN	1024
+#define BNXT_RX_COPY_THRESH_MAX	512
+
+/* TPA segments per aggregation histogram, bin b counts aggregations of
+ * [1 << b, 2 << b) segments, the last bin counts everything larger.
+ */
+#define BNXT_TPA_SEGS_HIST_BINS	7
+
 struct bnxt_rx_ring_info {
 	struct bnxt_napi	*bnapi;
 	struct bnxt_cp_ring_info	*rx_cpr;
@@ -1264,6 +1327,14 @@ struct bnxt_rx_ring_info {
 	u16			rx_agg_prod;
 	u16			rx_sw_agg_prod;
 	u16			rx_next_cons;
+	u16			rx_copy_thresh;
+	u16			rx_size_win_cnt;
+	u16			rx_size_win[BNXT_RX_SIZE_HIST_BINS];
+	u64			rx_size_hist[BNXT_RX_SIZE_HIST_BINS];
+	/* TPA slots currently open and the high water mark */
+	u16			tpa_inflight;
+	u16			tpa_inflight_max;
+	u64			tpa_segs_hist[BNXT_TPA_SEGS_HIST_BINS];
 #ifdef CONFIG_NETMAP
 	u32			netmap_idx;
 #endif
@@ -1297,6 +1368,8 @@ struct bnxt_rx_ring_info {
 #endif
 #ifdef CONFIG_PAGE_POOL
 	struct page_pool 	*page_pool;
+	/* RX head buffers carved from page fragments, non-XDP mode only */
+	struct page_pool	*head_pool;
 #endif
 	struct xsk_buff_pool	*xsk_pool;
 	u32                     flags;
@@ -1307,9 +1380,18 @@ struct bnxt_rx_ring_info {
 struct bnxt_rx_sw_stats {
 	u64			rx_hds;
 	u64			rx_tpa_hds;
+	u64			rx_hds_no_split;
 	u64			rx_l4_csum_errors;
 	u64			rx_resets;
 	u64			rx_buf_errors;
+	u64			rx_prefetch_passes;
+	u64			rx_prefetch_cmpls;
+	u64			rx_refill_db;
+	u64			rx_tpa_segs;
+	u64			rx_tpa_max_segs_end;
+	u64			rx_tpa_early_end;
+	u64			rx_tpa_sw_aborts;
+	u64			rx_queue_restarts;
 	u64			rx_oom_discards;
 	u64			rx_netpoll_discards;
 };
@@ -1317,15 +1399,36 @@ struct bnxt_rx_sw_stats {
 struct bnxt_tx_sw_push_stats {
 	u64			tx_push_xmit;
 	u64			tx_push_cmpl;
+	u64			tx_push_miss;
+	u64			tx_push_backoff;
+};
+
+/* tx_no_cmpl counts xmit_more packets sent without a completion request,
+ * tx_no_cmpl_limit the xmit_more packets that had to request one because
+ * the run hit tx_cmpl_max_bds or the BQL bound.
+ */
+struct bnxt_tx_sw_stats {
+	u64			tx_cmpl_req;
+	u64			tx_no_cmpl;
+	u64			tx_no_cmpl_limit;
+	u64			tx_reclaim_polls;
+	u64			tx_reclaim_bds;
 };
 
 struct bnxt_txtime_sw_stats {
 	u64			txtime_xmit;
 	u64			txtime_cmpl_err;
+	u64			txtime_edt_fallback;
 };
 
 struct bnxt_cmn_sw_stats {
 	u64			missed_irqs;
+	u64			xdp_tx_frames;
+	u64			xdp_tx_db;
+	u64			xdp_xmit_frames;
+	u64			xdp_xmit_db;
+	u64			xdp_xmit_locked;
+	u64			xdp_xmit_lock_contended;
 };
 
 struct bnxt_xsk_stats {
@@ -1337,11 +1440,14 @@ struct bnxt_xsk_stats {
 	u64                     xsk_wakeup;
 	u64                     xsk_tx_completed;
 	u64                     xsk_tx_sent_pkts;
+	u64                     xsk_rx_mb_pkts;
+	u64                     xsk_tx_mb_pkts;
 };
 
 struct bnxt_sw_stats {
 	struct bnxt_rx_sw_stats rx;
 	struct bnxt_tx_sw_push_stats tx;
+	struct bnxt_tx_sw_stats	tx_sw;
 	struct bnxt_txtime_sw_stats txtime;
 	struct bnxt_cmn_sw_stats cmn;
 	struct bnxt_xsk_stats	xsk_stats;
@@ -1377,15 +1483,22 @@ struct bnxt_cp_ring_info {
 	u8			toggle;
 	u8			cp_ring_type;
 	u8			cp_idx;
+	/* Per NAPI DIM enables; set from the global setting or per queue */
+	u8			rx_dim_en;
+	u8			tx_dim_en;
 
 	u32			last_cp_raw_cons;
 
 	struct bnxt_coal	rx_ring_coal;
+	struct bnxt_coal	tx_ring_coal;
 	u64			rx_packets;
 	u64			rx_bytes;
+	u64			tx_packets;
+	u64			tx_bytes;
 	u64			event_ctr;
 
 	struct dim		dim;
+	struct dim		tx_dim;
 
 	union {
 		struct tx_cmp	**cp_desc_ring;
@@ -1442,6 +1555,18 @@ struct bnxt_napi {
 	bool			in_reset;
 };
 
+/* Before P5, a NAPI with an RX ring takes its TX completions on the same
+ * completion ring, so TX coalescing cannot be set apart from RX.
+ */
+#define BNXT_NAPI_TX_COAL(bp, bnapi)					\
+	((bnapi)->tx_ring[0] &&						\
+	 (!(bnapi)->rx_ring || ((bp)->flags & BNXT_FLAG_CHIP_P5_PLUS)))
+
+/* Same for the TX side of a combined channel, before the rings exist */
+#define BNXT_QUEUE_TX_FOLLOWS_RX(bp)					\
+	(((bp)->flags & BNXT_FLAG_SHARED_RINGS) &&			\
+	 !((bp)->flags & BNXT_FLAG_CHIP_P5_PLUS))
+
 #ifdef BNXT_PRIV_RX_BUSY_POLL
 enum bnxt_poll_state_t {
 	BNXT_STATE_IDLE = 0,
@@ -1696,6 +1821,7 @@ struct bnxt_filter_base {
 #define BNXT_FLTR_VALID		0
 #define BNXT_FLTR_INSERTED	1
 #define BNXT_FLTR_FW_DELETED	2
+#define BNXT_FLTR_PENDING	3
 
 	struct rcu_head		rcu;
 };
@@ -1716,6 +1842,8 @@ struct bnxt_ntuple_filter {
 	struct bnxt_flow_masks	fmasks;
 	struct bnxt_l2_filter	*l2_fltr;
 	u32			flow_id;
+	struct llist_node	new_node;
+	ktime_t			queued;
 };
 
 struct bnxt_l2_key {
@@ -2622,8 +2750,9 @@ struct bnxt {
 	#define BNXT_FLAG_TPA		(BNXT_FLAG_LRO | BNXT_FLAG_GRO)
 	#define BNXT_FLAG_JUMBO		0x10
 	#define BNXT_FLAG_STRIP_VLAN	0x20
+	#define BNXT_FLAG_HDS		0x40
 	#define BNXT_FLAG_AGG_RINGS	(BNXT_FLAG_JUMBO | BNXT_FLAG_GRO | \
-					 BNXT_FLAG_LRO)
+					 BNXT_FLAG_LRO | BNXT_FLAG_HDS)
 	#define BNXT_FLAG_RFS		0x100
 	#define BNXT_FLAG_SHARED_RINGS	0x200
 	#define BNXT_FLAG_PORT_STATS	0x400
@@ -2672,6 +2801,12 @@ struct bnxt {
 				 (!((bp)->flags & BNXT_FLAG_CHIP_P5_PLUS) ||	\
 				  (bp)->max_tpa_v2) && !is_kdump_kernel())
 #define BNXT_RX_JUMBO_MODE(bp) ((bp)->flags & BNXT_FLAG_JUMBO)
+/* Header-data split is programmed whenever non-XDP aggregation rings are
+ * in use, unless the user turned it off.
+ */
+#define BNXT_HDS_ACTIVE(bp)	(((bp)->flags & BNXT_FLAG_AGG_RINGS) &&	\
+				 !BNXT_RX_PAGE_MODE(bp) &&		\
+				 (bp)->hds_cfg != BNXT_HDS_OFF)
 
 #define BNXT_CHIP_P7(bp)			\
 	((bp)->chip_num == CHIP_NUM_58818 ||	\
@@ -2759,6 +2894,12 @@ struct bnxt {
 	u32			rx_ring_size;
 	u32			rx_agg_ring_size;
 	u32			rx_copy_thresh;
+	u16			hds_thresh;
+#define BNXT_HDS_THRESHOLD_MAX	1023
+	u8			hds_cfg;
+#define BNXT_HDS_AUTO		0
+#define BNXT_HDS_ON		1
+#define BNXT_HDS_OFF		2
 	u32			rx_ring_mask;
 	u32			rx_agg_ring_mask;
 	int			rx_nr_pages;
@@ -2780,6 +2921,9 @@ struct bnxt {
 #if defined(HAVE_ETF_QOPT_OFFLOAD)
 	unsigned long           *etf_tx_ring_map;
 #endif
+	/* Use timed BDs for EDT stamped skbs on all non-ETF TX rings */
+	u8			tx_edt;
+#define BNXT_TX_EDT_HORIZON_NS	(10 * NSEC_PER_MSEC)
 
 	u32			cp_ring_size;
 	u32			cp_ring_mask;
@@ -2798,6 +2942,8 @@ struct bnxt {
 	u32			rss_hash_delta;
 	u16			*rss_indir_tbl;
 	u16			rss_indir_tbl_entries;
+	/* RX ring left out of the RSS tables while it restarts, or 0 */
+	u16			rss_skip_ring;
 #define	HW_HASH_KEY_SIZE	40
 	u8			rss_hash_key[HW_HASH_KEY_SIZE];
 	u8			rss_hash_key_valid:1;
@@ -2963,6 +3109,8 @@ struct bnxt {
 	u16                     hwrm_cmd_kong_seq;
 	struct dma_pool		*hwrm_dma_pool;
 	struct hlist_head	hwrm_pending_list;
+	/* per req_type driver vs firmware time, see __hwrm_send() */
+	struct bnxt_hwrm_type_stats	*hwrm_stats;
 
 #ifdef NETDEV_GET_STATS64
 	struct rtnl_link_stats64	net_stats_prev;
@@ -3021,6 +3169,9 @@ struct bnxt {
 	struct bnxt_coal_cap	coal_cap;
 	struct bnxt_coal	rx_coal;
 	struct bnxt_coal	tx_coal;
+	u8			tx_dim_en;
+	struct bnxt_queue_coal	*queue_coal;
+	u16			queue_coal_cnt;
 
 	u32			stats_coal_ticks;
 #define BNXT_DEF_STATS_COAL_TICKS	 1000000
@@ -3057,6 +3208,7 @@ struct bnxt {
 #define BNXT_RESET_TASK_CORE_RESET_SP_EVENT	25
 #define BNXT_THERMAL_THRESHOLD_SP_EVENT	26
 #define BNXT_RESTART_ULP_SP_EVENT	27
+#define BNXT_TPA_ADAPT_SP_EVENT		28
 
 	struct delayed_work	fw_reset_task;
 	int			fw_reset_state;
@@ -3108,15 +3260,38 @@ struct bnxt {
 	void __iomem		*db_base_wc;
 
 #define BNXT_NTP_FLTR_MAX_FLTR	8192
+/* The ntuple hash table is sized from max_fltr when it is allocated,
+ * aiming for BNXT_NTP_FLTR_BUCKET_DEPTH entries per bucket, but never
+ * below BNXT_NTP_FLTR_HASH_SIZE buckets.
+ */
 #define BNXT_NTP_FLTR_HASH_SIZE	512
-#define BNXT_NTP_FLTR_HASH_MASK	(BNXT_NTP_FLTR_HASH_SIZE - 1)
-	struct hlist_head	ntp_fltr_hash_tbl[BNXT_NTP_FLTR_HASH_SIZE];
+#define BNXT_NTP_FLTR_BUCKET_DEPTH	4
+	struct hlist_head	*ntp_fltr_hash_tbl;
+	u32			ntp_fltr_hash_size;
+	u32			ntp_fltr_hash_mask;
 	spinlock_t		ntp_fltr_lock;	/* for hash table add, del */
 
 	unsigned long		*ntp_fltr_bmap;
 	int			ntp_fltr_count;
 	int			max_fltr;
 
+	/* aRFS filters waiting to be programmed into hardware */
+	struct llist_head	ntp_fltr_new_list;
+	atomic_t		ntp_fltr_pending;
+#define BNXT_NTP_FLTR_MAX_PENDING	2048
+/* Number of hash buckets scanned for expired aRFS filters per pass */
+#define BNXT_NTP_FLTR_EXPIRE_SCAN	1024
+	u32			ntp_fltr_expire_idx;
+
+#define BNXT_NTP_FLTR_INSTALL		0
+#define BNXT_NTP_FLTR_INSTALL_ERR	1
+#define BNXT_NTP_FLTR_EXPIRE		2
+#define BNXT_NTP_FLTR_BACKLOG_DROP	3
+#define BNXT_NTP_FLTR_LAT_TOTAL_US	4
+#define BNXT_NTP_FLTR_LAT_MAX_US	5
+#define BNXT_NTP_FLTR_MAX_COUNTERS	6
+	atomic64_t		ntp_fltr_counters[BNXT_NTP_FLTR_MAX_COUNTERS];
+
 #define BNXT_L2_FLTR_MAX_FLTR	1024
 #define BNXT_MAX_FLTR		(BNXT_NTP_FLTR_MAX_FLTR + BNXT_L2_FLTR_MAX_FLTR)
 #define BNXT_L2_FLTR_HASH_SIZE	32
@@ -3257,6 +3432,11 @@ do {									\
 	struct vnic_info_meta	*vnic_meta;
 #endif
 	bool			dl_param_truflow;
+	/* TruFlow flow counter poll interval in msec, 0 selects the default */
+	u32			tf_fc_poll_interval;
+#define BNXT_TF_FC_POLL_INTERVAL_DEF	1000
+#define BNXT_TF_FC_POLL_INTERVAL_MIN	100
+#define BNXT_TF_FC_POLL_INTERVAL_MAX	60000
 	/* Truflow MPC info */
 	void *tfc_info;
 	/* Truflow Related: END */
@@ -3275,6 +3455,26 @@ do {									\
 	void			*hdbr_pgs[DBC_GROUP_MAX];
 	u8			rss_hfunc;
 	u8                      ipv6_flow_lbl_rss_en;
+	u8			rx_prefetch_en;
+	u8			rx_copybreak_adapt;
+
+	/* Adaptive TPA: each level halves max_agg_segs and the aggregation
+	 * timer relative to the defaults.
+	 */
+	u8			tpa_adapt;
+	u8			tpa_adapt_lvl;
+#define BNXT_TPA_ADAPT_LVL_MAX		3
+	u16			tpa_seg_limit;
+	u32			tpa_timer_dflt;
+	u64			tpa_adapt_aggs;
+	u64			tpa_adapt_segs;
+	u64			tpa_adapt_max_ends;
+
+	/* Size the XDP TX rings to one per CPU when a program is attached
+	 * so that ndo_xdp_xmit does not need the ring lock.
+	 */
+	u8			xdp_tx_per_cpu;
+	u16			xdp_saved_rx_rings;
 
 	int			ulp_num_msix_want;
 
@@ -3574,6 +3774,16 @@ static inline void bnxt_do_pacing_default(struct bnxt *bp, u32 *seed)
 		       BNXT_DEFAULT_PACING_PROBABILITY);
 }
 
+/* Returns the per queue coalescing of @queue if any of it is set */
+static inline struct bnxt_queue_coal *bnxt_queue_coal(struct bnxt *bp,
+						      u32 queue)
+{
+	if (!bp->queue_coal || queue >= bp->queue_coal_cnt ||
+	    !bp->queue_coal[queue].flags)
+		return NULL;
+	return &bp->queue_coal[queue];
+}
+
 extern const u16 bnxt_lhint_arr[];
 extern const struct pci_device_id bnxt_pci_tbl[];
 
@@ -3587,6 +3797,8 @@ void bnxt_free_ring(struct bnxt *bp, struct bnxt_ring_mem_info *rmem);
 int bnxt_alloc_ring(struct bnxt *bp, struct bnxt_ring_mem_info *rmem);
 void bnxt_set_tpa_flags(struct bnxt *bp);
 void bnxt_set_ring_params(struct bnxt *);
+void bnxt_set_rx_copybreak_adapt(struct bnxt *bp, bool enable);
+int bnxt_update_napi_coal(struct bnxt *bp, struct bnxt_napi *bnapi);
 int bnxt_set_rx_skb_mode(struct bnxt *bp, bool page_mode);
 int bnxt_hwrm_func_drv_rgtr(struct bnxt *bp, unsigned long *bmap,
 			    int bmap_size, bool async_only);
@@ -3613,6 +3825,7 @@ void bnxt_hwrm_tx_ring_free(struct bnxt *bp, struct bnxt_tx_ring_info *txr,
 			    bool close_path);
 void bnxt_hwrm_rx_ring_free(struct bnxt *bp, struct bnxt_rx_ring_info *rxr,
 			    bool close_path);
+int bnxt_restart_rx_queue(struct bnxt *bp, int idx);
 int bnxt_total_tx_rings(struct bnxt *bp);
 int __bnxt_hwrm_get_tx_rings(struct bnxt *bp, u16 fid, int *tx_rings);
 int bnxt_nq_rings_in_use(struct bnxt *bp);
@@ -3671,8 +3884,11 @@ int bnxt_get_port_parent_id(struct net_device *dev,
 int bnxt_port_attr_get(struct bnxt *bp, struct switchdev_attr *attr);
 #endif
 #endif
+void bnxt_dim_tx_cmpl_update(struct bnxt_napi *bnapi, struct dim *dim);
 void bnxt_dim_work(struct work_struct *work);
+void bnxt_tx_dim_work(struct work_struct *work);
 int bnxt_hwrm_set_ring_coal(struct bnxt *bp, struct bnxt_napi *bnapi);
+int bnxt_hwrm_set_ring_tx_coal(struct bnxt *bp, struct bnxt_napi *bnapi);
 u32 bnxt_fw_health_readl(struct bnxt *bp, int reg_idx);
 int bnxt_alloc_stats_mem(struct bnxt *bp, struct bnxt_stats_mem *stats, bool alloc_masks);
 void bnxt_free_stats_mem(struct bnxt *bp, struct bnxt_stats_mem *stats);
@@ -3707,6 +3923,10 @@ void bnxt_deliver_skb(struct bnxt *bp, struct bnxt_napi *bnapi,
 		      u32 vlan, struct sk_buff *skb);
 void bnxt_txr_db_kick(struct bnxt *bp, struct bnxt_tx_ring_info *txr,
 		      u16 prod);
+#if defined(HAVE_ETF_QOPT_OFFLOAD)
+bool bnxt_tx_edt_supported(struct bnxt *bp);
+void bnxt_set_txr_txtime(struct bnxt *bp);
+#endif
 int bnxt_agg_bufs_valid(struct bnxt *bp, struct bnxt_cp_ring_info *cpr,
 			u8 agg_bufs, u32 *raw_cons);
 struct rx_agg_cmp *bnxt_get_agg(struct bnxt *bp, struct bnxt_cp_ring_info *cpr,
@@ -678,6 +678,10 @@ typedef unsigned long netdev_features_t;
 #define napi_build_skb(data, frag_size) build_skb(data, frag_size)
 #endif
 
+#ifndef HAVE_NAPI_CONSUME_SKB
+#define napi_consume_skb(skb, budget) dev_consume_skb_any(skb)
+#endif
+
 #ifndef __rcu
 #define __rcu
 #endif
@@ -2653,14 +2657,67 @@ static inline void hwmon_notify_event(struct device *dev, enum hwmon_sensor_type
 
 #if !defined(HAVE_PAGE_POOL_PP_FRAG_BIT)
 #define PP_FLAG_PAGE_FRAG	0
+#endif
 
+#if !defined(HAVE_PAGE_POOL_PAGE_FRAG)
 #define page_pool_dev_alloc_frag(page_pool, offset, size)	NULL
 #endif
 
+#if defined(CONFIG_PAGE_POOL) && defined(HAVE_BUILD_SKB) &&		\
+	defined(HAVE_PAGE_POOL_PAGE_FRAG) &&				\
+	defined(HAVE_PAGE_POOL_GET_DMA_ADDR) &&				\
+	defined(HAVE_SKB_MARK_RECYCLE) && !defined(HAVE_OLD_SKB_MARK_RECYCLE)
+#define HAVE_BNXT_RX_HEAD_POOL
+#endif
+
+/* A device with queue_mgmt_ops is "ops locked" on newer kernels: the core
+ * holds the netdev instance lock around ndo_open/ndo_stop, the ethtool ops
+ * and the queue ops.  NAPI must then be toggled with the _locked variants,
+ * and the driver's own reopen paths take the instance lock themselves.
+ */
+#ifdef HAVE_NETDEV_LOCK_OPS
+#define bnxt_netdev_lock(dev)			netdev_lock(dev)
+#define bnxt_netdev_unlock(dev)			netdev_unlock(dev)
+#define bnxt_napi_enable(napi)			napi_enable_locked(napi)
+#define bnxt_napi_disable(napi)			napi_disable_locked(napi)
+#define bnxt_netif_napi_add(dev, napi, poll)	netif_napi_add_locked(dev, napi, poll)
+#define bnxt_netif_napi_del(napi)		__netif_napi_del_locked(napi)
+#define bnxt_dev_close(dev)			netif_close(dev)
+#else
+#define bnxt_netdev_lock(dev)			do {} while (0)
+#define bnxt_netdev_unlock(dev)			do {} while (0)
+#define bnxt_napi_enable(napi)			napi_enable(napi)
+#define bnxt_napi_disable(napi)			napi_disable(napi)
+#define bnxt_netif_napi_add(dev, napi, poll)	___netif_napi_add(dev, napi, poll)
+#define bnxt_netif_napi_del(napi)		__netif_napi_del(napi)
+#define bnxt_dev_close(dev)			dev_close(dev)
+#endif
+
+#if defined(CONFIG_PAGE_POOL) && defined(HAVE_BUILD_SKB) &&		\
+	defined(HAVE_PAGE_POOL_NETMEM) && defined(HAVE_NETDEV_QMGMT_OPS) &&	\
+	defined(HAVE_SKB_MARK_RECYCLE) && !defined(HAVE_OLD_SKB_MARK_RECYCLE)
+#define HAVE_BNXT_RX_NETMEM
+#endif
+
 #ifndef PP_FLAG_DMA_SYNC_DEV
 #define PP_FLAG_DMA_SYNC_DEV	0
 #endif
 
+/* True if skb->tstamp is a CLOCK_MONOTONIC departure time.  Kernels that
+ * do not tag the clock clear the receive time of forwarded skbs, so any
+ * stamp seen on transmit is a departure time.
+ */
+static inline bool bnxt_skb_tstamp_mono(const struct sk_buff *skb)
+{
+#if defined(HAVE_SKB_TSTAMP_TYPE)
+	return skb->tstamp_type == SKB_CLOCK_MONOTONIC;
+#elif defined(HAVE_SKB_MONO_DELIVERY_TIME)
+	return skb->mono_delivery_time;
+#else
+	return true;
+#endif
+}
+
 #if (defined(GRO_MAX_SIZE) && (GRO_MAX_SIZE > 65536))
 #define HAVE_IPV6_BIG_TCP
 #endif
@@ -284,8 +284,10 @@ static int bnxt_queue_remap(struct bnxt *bp, unsigned int lltc_mask)
 	}
 
 	if (netif_running(bp->dev)) {
+		bnxt_netdev_lock(bp->dev);
 		bnxt_close_nic(bp, false, false);
 		rc = bnxt_open_nic(bp, false, false);
+		bnxt_netdev_unlock(bp->dev);
 		if (rc) {
 			netdev_warn(bp->dev, "failed to open NIC, rc = %d\n", rc);
 			return rc;
@@ -636,7 +638,9 @@ static int bnxt_dcbnl_ieee_setets(struct net_device *dev, struct ieee_ets *ets)
 		if (!bp->ieee_ets)
 			return -ENOMEM;
 	}
+	bnxt_netdev_lock(dev);
 	rc = bnxt_setup_mq_tc(dev, max_tc);
+	bnxt_netdev_unlock(dev);
 	if (rc)
 		goto error;
 	rc = bnxt_hwrm_queue_cos2bw_cfg(bp, ets, max_tc);
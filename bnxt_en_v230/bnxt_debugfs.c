@@ -11,6 +11,7 @@
 #include <linux/debugfs.h>
 #include <linux/module.h>
 #include <linux/pci.h>
+#include <linux/seq_file.h>
 #include "bnxt_hsi.h"
 #include "bnxt_compat.h"
 #ifdef HAVE_DIM
@@ -24,6 +25,7 @@
 #include "bnxt_udcc.h"
 #include "cfa_types.h"
 #include "bnxt_vfr.h"
+#include "bnxt_hwrm.h"
 
 #ifdef CONFIG_DEBUG_FS
 
@@ -469,6 +471,133 @@ static void bnxt_debugfs_hdbr_init(struct bnxt *bp)
 	}
 }
 
+static int hwrm_stats_show(struct seq_file *m, void *unused)
+{
+	struct bnxt *bp = m->private;
+	struct bnxt_hwrm_type_stats *stats;
+	u64 count, lock_ns, drv_ns, fw_ns;
+	u32 type;
+
+	if (!bp->hwrm_stats)
+		return 0;
+
+	seq_puts(m, "req_type      count  avg_lock_ns   avg_drv_ns    avg_fw_ns\n");
+	for (type = 0; type <= BNXT_HWRM_STATS_MAX_TYPE; type++) {
+		stats = &bp->hwrm_stats[type];
+		count = atomic64_read(&stats->count);
+		if (!count)
+			continue;
+		lock_ns = atomic64_read(&stats->lock_ns);
+		drv_ns = atomic64_read(&stats->drv_ns);
+		fw_ns = atomic64_read(&stats->fw_ns);
+		if (type == BNXT_HWRM_STATS_MAX_TYPE)
+			seq_puts(m, "   other");
+		else
+			seq_printf(m, "  0x%04x", type);
+		seq_printf(m, " %10llu %12llu %12llu %12llu\n", count,
+			   div64_u64(lock_ns, count), div64_u64(drv_ns, count),
+			   div64_u64(fw_ns, count));
+	}
+	return 0;
+}
+
+static int hwrm_stats_open(struct inode *inode, struct file *filep)
+{
+	return single_open(filep, hwrm_stats_show, inode->i_private);
+}
+
+static const struct file_operations hwrm_stats_fops = {
+	.owner		= THIS_MODULE,
+	.open		= hwrm_stats_open,
+	.read		= seq_read,
+	.llseek		= seq_lseek,
+	.release	= single_release,
+};
+
+static int rx_copybreak_show(struct seq_file *m, void *unused)
+{
+	struct bnxt *bp = m->private;
+	char label[16];
+	int i, j;
+
+	if (!bp->rx_ring)
+		return 0;
+
+	seq_puts(m, "ring thresh");
+	for (j = 0; j < BNXT_RX_SIZE_HIST_BINS - 1; j++) {
+		snprintf(label, sizeof(label), "<=%u", BNXT_RX_SIZE_BIN_EDGE(j));
+		seq_printf(m, " %15s", label);
+	}
+	snprintf(label, sizeof(label), ">%u", BNXT_RX_SIZE_BIN_EDGE(j - 1));
+	seq_printf(m, " %15s\n", label);
+	for (i = 0; i < bp->rx_nr_rings; i++) {
+		struct bnxt_rx_ring_info *rxr = &bp->rx_ring[i];
+
+		seq_printf(m, "%4d %6u", i, READ_ONCE(rxr->rx_copy_thresh));
+		for (j = 0; j < BNXT_RX_SIZE_HIST_BINS; j++)
+			seq_printf(m, " %15llu", READ_ONCE(rxr->rx_size_hist[j]));
+		seq_putc(m, '\n');
+	}
+	return 0;
+}
+
+static int rx_copybreak_open(struct inode *inode, struct file *filep)
+{
+	return single_open(filep, rx_copybreak_show, inode->i_private);
+}
+
+static const struct file_operations rx_copybreak_fops = {
+	.owner		= THIS_MODULE,
+	.open		= rx_copybreak_open,
+	.read		= seq_read,
+	.llseek		= seq_lseek,
+	.release	= single_release,
+};
+
+static int tpa_stats_show(struct seq_file *m, void *unused)
+{
+	struct bnxt *bp = m->private;
+	char label[16];
+	int i, j;
+
+	if (!bp->rx_ring)
+		return 0;
+
+	seq_printf(m, "adapt level %u seg limit %u timer %u\n",
+		   bp->tpa_adapt_lvl, bp->tpa_seg_limit,
+		   bp->tpa_timer_dflt >> bp->tpa_adapt_lvl);
+	seq_puts(m, "ring inflight max");
+	for (j = 0; j < BNXT_TPA_SEGS_HIST_BINS - 1; j++) {
+		snprintf(label, sizeof(label), "<%u", 2U << j);
+		seq_printf(m, " %15s", label);
+	}
+	snprintf(label, sizeof(label), ">=%u", 1U << j);
+	seq_printf(m, " %15s\n", label);
+	for (i = 0; i < bp->rx_nr_rings; i++) {
+		struct bnxt_rx_ring_info *rxr = &bp->rx_ring[i];
+
+		seq_printf(m, "%4d %8u %3u", i, READ_ONCE(rxr->tpa_inflight),
+			   READ_ONCE(rxr->tpa_inflight_max));
+		for (j = 0; j < BNXT_TPA_SEGS_HIST_BINS; j++)
+			seq_printf(m, " %15llu", READ_ONCE(rxr->tpa_segs_hist[j]));
+		seq_putc(m, '\n');
+	}
+	return 0;
+}
+
+static int tpa_stats_open(struct inode *inode, struct file *filep)
+{
+	return single_open(filep, tpa_stats_show, inode->i_private);
+}
+
+static const struct file_operations tpa_stats_fops = {
+	.owner		= THIS_MODULE,
+	.open		= tpa_stats_open,
+	.read		= seq_read,
+	.llseek		= seq_lseek,
+	.release	= single_release,
+};
+
 #define BNXT_DEBUGFS_TRUFLOW "truflow"
 
 int bnxt_debug_tf_create(struct bnxt *bp, u8 tsid)
@@ -513,6 +642,20 @@ void bnxt_debug_tf_delete(struct bnxt *bp)
 		debugfs_remove_recursive(port_dir);
 }
 
+/* Per device TruFlow directory that, unlike bp->debugfs_pdev, is not torn
+ * down on every close and can be owned by the ULP context.
+ */
+struct dentry *bnxt_debug_tf_dev_dir_create(struct bnxt *bp, const char *prefix)
+{
+	char name[64];
+
+	if (!bnxt_debug_tf)
+		return NULL;
+
+	snprintf(name, sizeof(name), "%s_%s", prefix, pci_name(bp->pdev));
+	return debugfs_create_dir(name, bnxt_debug_tf);
+}
+
 void bnxt_debug_dev_init(struct bnxt *bp)
 {
 	const char *pname = pci_name(bp->pdev);
@@ -555,6 +698,13 @@ void bnxt_debug_dev_init(struct bnxt *bp)
 	debugfs_create_u32("dbr_test_recover_interval_ms", 0644, dir,
 			   &debug->recover_interval_ms);
 
+	debugfs_create_file("hwrm_stats", 0444, bp->debugfs_pdev, bp,
+			    &hwrm_stats_fops);
+	debugfs_create_file("rx_copybreak", 0444, bp->debugfs_pdev, bp,
+			    &rx_copybreak_fops);
+	debugfs_create_file("tpa_stats", 0444, bp->debugfs_pdev, bp,
+			    &tpa_stats_fops);
+
 	bnxt_debugfs_hdbr_init(bp);
 
 #if defined(CONFIG_BNXT_FLOWER_OFFLOAD)
@@ -19,6 +19,7 @@ void bnxt_debugfs_create_udcc_session(struct bnxt *bp, u32 session_id);
 void bnxt_debugfs_delete_udcc_session(struct bnxt *bp, u32 session_id);
 int bnxt_debug_tf_create(struct bnxt *bp, u8 tsid);
 void bnxt_debug_tf_delete(struct bnxt *bp);
+struct dentry *bnxt_debug_tf_dev_dir_create(struct bnxt *bp, const char *prefix);
 #else
 static inline void bnxt_debug_init(void) {}
 static inline void bnxt_debug_exit(void) {}
@@ -28,4 +29,8 @@ static inline void bnxt_debugfs_create_udcc_session(struct bnxt *bp, u32 session
 static inline void bnxt_debugfs_delete_udcc_session(struct bnxt *bp, u32 session_id) {}
 static inline int bnxt_debug_tf_create(struct bnxt *bp, u8 tsid) { return 0; }
 static inline void bnxt_debug_tf_delete(struct bnxt *bp) {}
+static inline struct dentry *bnxt_debug_tf_dev_dir_create(struct bnxt *bp, const char *prefix)
+{
+	return NULL;
+}
 #endif
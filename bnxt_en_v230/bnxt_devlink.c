@@ -826,8 +826,11 @@ static int bnxt_dl_reload_down(struct devlink *dl, bool netns_change,
 			rtnl_unlock();
 			return -EOPNOTSUPP;
 		}
-		if (netif_running(bp->dev))
+		if (netif_running(bp->dev)) {
+			bnxt_netdev_lock(bp->dev);
 			bnxt_close_nic(bp, true, true);
+			bnxt_netdev_unlock(bp->dev);
+		}
 		bnxt_vf_reps_free(bp);
 		rc = bnxt_hwrm_func_drv_unrgtr(bp);
 		if (rc) {
@@ -891,8 +894,11 @@ static int bnxt_dl_reload_up(struct devlink *dl, enum devlink_reload_action acti
 	case DEVLINK_RELOAD_ACTION_DRIVER_REINIT: {
 		bnxt_fw_init_one(bp);
 		bnxt_vf_reps_alloc(bp);
-		if (netif_running(bp->dev))
+		if (netif_running(bp->dev)) {
+			bnxt_netdev_lock(bp->dev);
 			rc = bnxt_open_nic(bp, true, true);
+			bnxt_netdev_unlock(bp->dev);
+		}
 		if (!rc) {
 			bnxt_reenable_sriov(bp);
 			bnxt_ptp_reapply_pps(bp);
@@ -1051,6 +1057,7 @@ enum bnxt_dl_param_id {
 	BNXT_DEVLINK_PARAM_ID_BASE = DEVLINK_PARAM_GENERIC_ID_MAX,
 	BNXT_DEVLINK_PARAM_ID_GRE_VER_CHECK,
 	BNXT_DEVLINK_PARAM_ID_TRUFLOW,
+	BNXT_DEVLINK_PARAM_ID_TRUFLOW_FC_POLL,
 };
 
 static const struct bnxt_dl_nvm_param nvm_params[] = {
@@ -1286,6 +1293,38 @@ static int bnxt_dl_truflow_param_set(struct devlink *dl, u32 id,
 	return rc;
 }
 
+static int bnxt_dl_truflow_fc_poll_get(struct devlink *dl, u32 id,
+				       struct devlink_param_gset_ctx *ctx)
+{
+	struct bnxt *bp = bnxt_get_bp_from_dl(dl);
+
+	ctx->val.vu32 = bp->tf_fc_poll_interval ?: BNXT_TF_FC_POLL_INTERVAL_DEF;
+	return 0;
+}
+
+/* Takes effect when the flow counter thread next reschedules itself */
+static int bnxt_dl_truflow_fc_poll_set(struct devlink *dl, u32 id,
+				       struct devlink_param_gset_ctx *ctx)
+{
+	struct bnxt *bp = bnxt_get_bp_from_dl(dl);
+
+	WRITE_ONCE(bp->tf_fc_poll_interval, ctx->val.vu32);
+	return 0;
+}
+
+static int bnxt_dl_truflow_fc_poll_validate(struct devlink *dl, u32 id,
+					    union devlink_param_value val,
+					    struct netlink_ext_ack *extack)
+{
+	if (val.vu32 < BNXT_TF_FC_POLL_INTERVAL_MIN ||
+	    val.vu32 > BNXT_TF_FC_POLL_INTERVAL_MAX) {
+		NL_SET_ERR_MSG_MOD(extack, "Flow counter poll interval is out of range");
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
 static const struct devlink_param bnxt_dl_params[] = {
 	DEVLINK_PARAM_GENERIC(ENABLE_SRIOV,
 			      BIT(DEVLINK_PARAM_CMODE_PERMANENT),
@@ -1316,6 +1355,12 @@ static const struct devlink_param bnxt_dl_params[] = {
 			     BIT(DEVLINK_PARAM_CMODE_RUNTIME),
 			     bnxt_dl_truflow_param_get, bnxt_dl_truflow_param_set,
 			     NULL),
+	DEVLINK_PARAM_DRIVER(BNXT_DEVLINK_PARAM_ID_TRUFLOW_FC_POLL,
+			     "truflow_fc_poll_interval", DEVLINK_PARAM_TYPE_U32,
+			     BIT(DEVLINK_PARAM_CMODE_RUNTIME),
+			     bnxt_dl_truflow_fc_poll_get,
+			     bnxt_dl_truflow_fc_poll_set,
+			     bnxt_dl_truflow_fc_poll_validate),
 #ifdef HAVE_REMOTE_DEV_RESET
 	/* keep REMOTE_DEV_RESET last, it is excluded based on caps */
 	DEVLINK_PARAM_GENERIC(ENABLE_REMOTE_DEV_RESET,
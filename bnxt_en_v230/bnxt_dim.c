@@ -19,6 +19,23 @@
 #include "bnxt_hsi.h"
 #include "bnxt.h"
 
+/* A ring that DIM keeps at a low latency profile gets TX completions
+ * more often: each step down from the top profile halves the number of
+ * BDs one completion may cover.  A NULL @dim restores the default once
+ * DIM is off on the NAPI.
+ */
+void bnxt_dim_tx_cmpl_update(struct bnxt_napi *bnapi, struct dim *dim)
+{
+	u16 max_bds = BNXT_TX_CMPL_MAX_BDS;
+	struct bnxt_tx_ring_info *txr;
+	int i;
+
+	if (dim)
+		max_bds >>= NET_DIM_PARAMS_NUM_PROFILES - 1 - dim->profile_ix;
+	bnxt_for_each_napi_tx(i, bnapi, txr)
+		WRITE_ONCE(txr->tx_cmpl_max_bds, max_bds);
+}
+
 void bnxt_dim_work(struct work_struct *work)
 {
 	struct dim *dim = container_of(work, struct dim, work);
@@ -34,10 +51,35 @@ void bnxt_dim_work(struct work_struct *work)
 	cpr->rx_ring_coal.coal_ticks = cur_moder.usec;
 	cpr->rx_ring_coal.coal_bufs = cur_moder.pkts;
 
+	/* TX DIM takes the TX completion bound over when enabled */
+	if (!cpr->tx_dim_en)
+		bnxt_dim_tx_cmpl_update(bnapi, dim);
+
 	bnxt_hwrm_set_ring_coal(bnapi->bp, bnapi);
 	dim->state = DIM_START_MEASURE;
 }
 
+void bnxt_tx_dim_work(struct work_struct *work)
+{
+	struct dim *dim = container_of(work, struct dim, work);
+	struct bnxt_cp_ring_info *cpr = container_of(dim,
+						     struct bnxt_cp_ring_info,
+						     tx_dim);
+	struct bnxt_napi *bnapi = container_of(cpr,
+					       struct bnxt_napi,
+					       cp_ring);
+	struct dim_cq_moder cur_moder =
+		net_dim_get_tx_moderation(dim->mode, dim->profile_ix);
+
+	cpr->tx_ring_coal.coal_ticks = cur_moder.usec;
+	cpr->tx_ring_coal.coal_bufs = cur_moder.pkts;
+
+	bnxt_dim_tx_cmpl_update(bnapi, dim);
+
+	bnxt_hwrm_set_ring_tx_coal(bnapi->bp, bnapi);
+	dim->state = DIM_START_MEASURE;
+}
+
 #ifndef HAVE_DIM
 void net_dim(struct dim *dim, struct dim_sample end_sample)
 {
@@ -63,12 +63,22 @@ enum bnxt_priv_flags {
 	BNXT_PRIV_FLAG_NUMA_DIRECT,
 	BNXT_PRIV_FLAG_CORE_RESET_TX_TIMEOUT,
 	BNXT_PRIV_FLAG_RSS_IPV6_FLOW_LABEL_EN,
+	BNXT_PRIV_FLAG_RX_PREFETCH,
+	BNXT_PRIV_FLAG_RX_COPYBREAK_ADAPT,
+	BNXT_PRIV_FLAG_TPA_ADAPT,
+	BNXT_PRIV_FLAG_XDP_TX_PER_CPU,
+	BNXT_PRIV_FLAG_TX_EDT,
 };
 
 static const char * const bnxt_priv_flags[] = {
 	[BNXT_PRIV_FLAG_NUMA_DIRECT] = "numa_direct",
 	[BNXT_PRIV_FLAG_CORE_RESET_TX_TIMEOUT] = "core_reset_tx_timeout",
 	[BNXT_PRIV_FLAG_RSS_IPV6_FLOW_LABEL_EN] = "ipv6_flow_label_rss_en",
+	[BNXT_PRIV_FLAG_RX_PREFETCH] = "rx_prefetch",
+	[BNXT_PRIV_FLAG_RX_COPYBREAK_ADAPT] = "adaptive_copybreak",
+	[BNXT_PRIV_FLAG_TPA_ADAPT] = "adaptive_tpa",
+	[BNXT_PRIV_FLAG_XDP_TX_PER_CPU] = "xdp_tx_per_cpu",
+	[BNXT_PRIV_FLAG_TX_EDT] = "tx_edt_offload",
 };
 
 static u32 bnxt_get_msglevel(struct net_device *dev)
@@ -97,6 +107,7 @@ static int bnxt_get_coalesce(struct net_device *dev,
 	memset(coal, 0, sizeof(*coal));
 
 	coal->use_adaptive_rx_coalesce = bp->flags & BNXT_FLAG_DIM;
+	coal->use_adaptive_tx_coalesce = bp->tx_dim_en;
 
 	hw_coal = &bp->rx_coal;
 	mult = hw_coal->bufs_per_record;
@@ -133,7 +144,9 @@ static int bnxt_get_per_queue_coalesce(struct net_device *dev, u32 queue,
 {
 	struct bnxt *bp = netdev_priv(dev);
 	struct bnxt_cp_ring_info *cpr;
+	struct bnxt_queue_coal *qc;
 	struct bnxt_coal *hw_coal;
+	struct bnxt_napi *bnapi;
 	u16 mult;
 
 	if (queue >= bp->rx_nr_rings && bp->flags & BNXT_FLAG_SHARED_RINGS)
@@ -142,6 +155,7 @@ static int bnxt_get_per_queue_coalesce(struct net_device *dev, u32 queue,
 	if (queue >= bp->rx_nr_rings && queue >= bp->tx_nr_rings_per_tc)
 		return -EINVAL;
 
+	qc = bnxt_queue_coal(bp, queue);
 	if (queue >= bp->rx_nr_rings)
 		goto tx_coal;
 
@@ -150,13 +164,20 @@ static int bnxt_get_per_queue_coalesce(struct net_device *dev, u32 queue,
 	hw_coal = &bp->rx_coal;
 	mult = hw_coal->bufs_per_record;
 
-	if (!bp->bnapi) {
-		coal->rx_coalesce_usecs = hw_coal->coal_ticks;
-		coal->rx_max_coalesced_frames = hw_coal->coal_bufs / mult;
-	} else {
+	coal->rx_coalesce_usecs = hw_coal->coal_ticks;
+	coal->rx_max_coalesced_frames = hw_coal->coal_bufs / mult;
+	if (bp->bnapi) {
 		cpr = &bp->bnapi[queue]->cp_ring;
+		coal->use_adaptive_rx_coalesce = cpr->rx_dim_en;
 		coal->rx_coalesce_usecs = cpr->rx_ring_coal.coal_ticks;
 		coal->rx_max_coalesced_frames = cpr->rx_ring_coal.coal_bufs / mult;
+	} else if (qc && (qc->flags & BNXT_QUEUE_COAL_RX)) {
+		coal->use_adaptive_rx_coalesce = qc->rx_dim_en;
+		if (!qc->rx_dim_en) {
+			coal->rx_coalesce_usecs = qc->rx_coal_ticks;
+			coal->rx_max_coalesced_frames =
+				qc->rx_coal_bufs / mult;
+		}
 	}
 	coal->rx_coalesce_usecs_irq = hw_coal->coal_ticks_irq;
 	coal->rx_max_coalesced_frames_irq = hw_coal->coal_bufs_irq / mult;
@@ -167,14 +188,129 @@ tx_coal:
 
 	hw_coal = &bp->tx_coal;
 	mult = hw_coal->bufs_per_record;
-	coal->tx_coalesce_usecs = hw_coal->coal_ticks;
-	coal->tx_max_coalesced_frames = hw_coal->coal_bufs / mult;
 	coal->tx_coalesce_usecs_irq = hw_coal->coal_ticks_irq;
 	coal->tx_max_coalesced_frames_irq = hw_coal->coal_bufs_irq / mult;
 
+	/* The TX completions of this queue share its RX completion ring */
+	if (queue < bp->rx_nr_rings && BNXT_QUEUE_TX_FOLLOWS_RX(bp)) {
+		coal->use_adaptive_tx_coalesce = coal->use_adaptive_rx_coalesce;
+		coal->tx_coalesce_usecs = coal->rx_coalesce_usecs;
+		coal->tx_max_coalesced_frames = coal->rx_max_coalesced_frames;
+		goto skip_tx_coal;
+	}
+
+	coal->use_adaptive_tx_coalesce = bp->tx_dim_en;
+	coal->tx_coalesce_usecs = hw_coal->coal_ticks;
+	coal->tx_max_coalesced_frames = hw_coal->coal_bufs / mult;
+	if (bp->bnapi && bp->tx_ring) {
+		bnapi = bp->tx_ring[bp->tx_ring_map[queue]].bnapi;
+		if (BNXT_NAPI_TX_COAL(bp, bnapi)) {
+			cpr = &bnapi->cp_ring;
+			coal->use_adaptive_tx_coalesce = cpr->tx_dim_en;
+			coal->tx_coalesce_usecs = cpr->tx_ring_coal.coal_ticks;
+			coal->tx_max_coalesced_frames =
+				cpr->tx_ring_coal.coal_bufs / mult;
+		}
+	} else if (qc && (qc->flags & BNXT_QUEUE_COAL_TX)) {
+		coal->use_adaptive_tx_coalesce = qc->tx_dim_en;
+		if (!qc->tx_dim_en) {
+			coal->tx_coalesce_usecs = qc->tx_coal_ticks;
+			coal->tx_max_coalesced_frames =
+				qc->tx_coal_bufs / mult;
+		}
+	}
+
 skip_tx_coal:
 	return 0;
 }
+
+static int bnxt_alloc_queue_coal(struct bnxt *bp)
+{
+	u16 cnt = max(bp->dev->num_rx_queues, bp->dev->num_tx_queues);
+
+	if (bp->queue_coal)
+		return 0;
+
+	bp->queue_coal = kcalloc(cnt, sizeof(*bp->queue_coal), GFP_KERNEL);
+	if (!bp->queue_coal)
+		return -ENOMEM;
+	bp->queue_coal_cnt = cnt;
+	return 0;
+}
+
+/* Only the interrupt timer and frame count of a queue, and whether DIM
+ * runs on it, can be set apart from the global settings; the _irq values
+ * and CQE mode stay global.  The settings are kept in bp->queue_coal, so
+ * they can be set while the device is down and survive a reopen.  A
+ * global set_coalesce returns every queue to the global settings.
+ */
+static int bnxt_set_per_queue_coalesce(struct net_device *dev, u32 queue,
+				       struct ethtool_coalesce *coal)
+{
+	struct bnxt *bp = netdev_priv(dev);
+	struct bnxt_queue_coal *qc;
+	struct bnxt_napi *bnapi;
+	bool rx, tx;
+	int rc;
+
+	if (queue >= bp->rx_nr_rings && bp->flags & BNXT_FLAG_SHARED_RINGS)
+		return -EINVAL;
+
+	if (queue >= bp->rx_nr_rings && queue >= bp->tx_nr_rings_per_tc)
+		return -EINVAL;
+
+	rx = queue < bp->rx_nr_rings;
+	tx = queue < bp->tx_nr_rings_per_tc;
+
+	/* Before P5, a combined channel takes its TX completions on the RX
+	 * completion ring, so TX can only follow RX.
+	 */
+	if (rx && tx && BNXT_QUEUE_TX_FOLLOWS_RX(bp)) {
+		if (!coal->use_adaptive_tx_coalesce !=
+		    !coal->use_adaptive_rx_coalesce ||
+		    coal->tx_coalesce_usecs != coal->rx_coalesce_usecs ||
+		    coal->tx_max_coalesced_frames !=
+		    coal->rx_max_coalesced_frames)
+			return -EOPNOTSUPP;
+		tx = false;
+	}
+
+	rc = bnxt_alloc_queue_coal(bp);
+	if (rc)
+		return rc;
+
+	qc = &bp->queue_coal[queue];
+	if (rx) {
+		qc->flags |= BNXT_QUEUE_COAL_RX;
+		qc->rx_dim_en = !!coal->use_adaptive_rx_coalesce;
+		qc->rx_coal_ticks = coal->rx_coalesce_usecs;
+		qc->rx_coal_bufs = coal->rx_max_coalesced_frames *
+				   bp->rx_coal.bufs_per_record;
+	}
+	if (tx) {
+		qc->flags |= BNXT_QUEUE_COAL_TX;
+		qc->tx_dim_en = !!coal->use_adaptive_tx_coalesce;
+		qc->tx_coal_ticks = coal->tx_coalesce_usecs;
+		qc->tx_coal_bufs = coal->tx_max_coalesced_frames *
+				   bp->tx_coal.bufs_per_record;
+	}
+
+	/* Applied by bnxt_init_napi_coal() on the next open */
+	if (!test_bit(BNXT_STATE_OPEN, &bp->state))
+		return 0;
+
+	if (rx) {
+		rc = bnxt_update_napi_coal(bp, bp->bnapi[queue]);
+		if (rc)
+			return rc;
+	}
+	if (tx) {
+		bnapi = bp->tx_ring[bp->tx_ring_map[queue]].bnapi;
+		if (!rx || bnapi != bp->bnapi[queue])
+			rc = bnxt_update_napi_coal(bp, bnapi);
+	}
+	return rc;
+}
 #endif
 
 static int bnxt_set_coalesce(struct net_device *dev,
@@ -188,6 +324,11 @@ static int bnxt_set_coalesce(struct net_device *dev,
 	int rc = 0;
 	u16 mult;
 
+	bp->tx_dim_en = !!coal->use_adaptive_tx_coalesce;
+	if (bp->queue_coal)
+		memset(bp->queue_coal, 0,
+		       bp->queue_coal_cnt * sizeof(*bp->queue_coal));
+
 	if (coal->use_adaptive_rx_coalesce) {
 		bp->flags |= BNXT_FLAG_DIM;
 	} else {
@@ -304,23 +445,49 @@ static const char *bnxt_ring_tpa2_stats_str[] = {
 static const char *const bnxt_rx_sw_stats_str[] = {
 	"rx_hds_pkt",
 	"rx_tpa_hds_pkt",
+	"rx_hds_no_split_pkt",
 	"rx_l4_csum_errors",
 	"rx_resets",
 	"rx_buf_errors",
+	"rx_prefetch_passes",
+	"rx_prefetch_cmpls",
+	"rx_refill_db",
+	"rx_tpa_segs",
+	"rx_tpa_max_segs_end",
+	"rx_tpa_early_end",
+	"rx_tpa_sw_aborts",
+	"rx_queue_restarts",
 };
 
 static const char *const bnxt_tx_sw_push_stats_str[] = {
 	"tx_push_xmit",
 	"tx_push_cmpl",
+	"tx_push_miss",
+	"tx_push_backoff",
+};
+
+static const char *const bnxt_tx_sw_stats_str[] = {
+	"tx_cmpl_req",
+	"tx_no_cmpl",
+	"tx_no_cmpl_limit",
+	"tx_reclaim_polls",
+	"tx_reclaim_bds",
 };
 
 static const char *const bnxt_cmn_sw_stats_str[] = {
 	"missed_irqs",
+	"xdp_tx_frames",
+	"xdp_tx_doorbells",
+	"xdp_xmit_frames",
+	"xdp_xmit_doorbells",
+	"xdp_xmit_locked",
+	"xdp_xmit_lock_contended",
 };
 
 static const char *const bnxt_txtime_sw_stats_str[] = {
 	"so_txtime_xmit",
 	"so_txtime_cmpl_errors",
+	"so_txtime_edt_fallback",
 };
 
 #define BNXT_RX_STATS_ENTRY(counter)	\
@@ -468,6 +635,15 @@ static const char *const bnxt_ring_err_stats_arr[] = {
 	"total_missed_irqs",
 };
 
+static const char *const bnxt_ntp_fltr_stats[] = {
+	"rfs_fltr_installs",
+	"rfs_fltr_install_errors",
+	"rfs_fltr_expired",
+	"rfs_fltr_backlog_drops",
+	"rfs_fltr_install_lat_avg_us",
+	"rfs_fltr_install_lat_max_us",
+};
+
 static const char *const bnxt_ktls_stats[] = {
 	"ktls_tx_add",
 	"ktls_tx_del",
@@ -521,6 +697,8 @@ static const char *const bnxt_xsk_stats[] = {
 	"xsk_wakeup",
 	"xsk_tx_completed",
 	"xsk_tx_sent_pkts",
+	"xsk_rx_mb_pkts",
+	"xsk_tx_mb_pkts",
 };
 
 static const char *const bnxt_lpbk_stats[] = {
@@ -543,6 +721,7 @@ struct stats_entry {
 
 #define NUM_RING_RX_SW_STATS		ARRAY_SIZE(bnxt_rx_sw_stats_str)
 #define NUM_RING_TX_PUSH_SW_STATS	ARRAY_SIZE(bnxt_tx_sw_push_stats_str)
+#define NUM_RING_TX_SW_STATS		ARRAY_SIZE(bnxt_tx_sw_stats_str)
 #define NUM_RING_CMN_SW_STATS		ARRAY_SIZE(bnxt_cmn_sw_stats_str)
 #define NUM_RING_RX_HW_STATS		ARRAY_SIZE(bnxt_ring_rx_stats_str)
 #define NUM_RING_TX_HW_STATS		ARRAY_SIZE(bnxt_ring_tx_stats_str)
@@ -693,6 +872,7 @@ static const struct {
 
 #define BNXT_NUM_ECN_PORT_STATS	ARRAY_SIZE(bnxt_ecn_port_stats_arr)
 #define BNXT_NUM_RING_ERR_STATS	ARRAY_SIZE(bnxt_ring_err_stats_arr)
+#define BNXT_NUM_NTP_FLTR_STATS	ARRAY_SIZE(bnxt_ntp_fltr_stats)
 #define BNXT_NUM_KTLS_STATS	ARRAY_SIZE(bnxt_ktls_stats)
 #define BNXT_NUM_PORT_STATS ARRAY_SIZE(bnxt_port_stats_arr)
 #define BNXT_NUM_STATS_PRI			\
@@ -738,7 +918,7 @@ static int bnxt_get_num_ring_stats(struct bnxt *bp)
 	rx = NUM_RING_RX_HW_STATS + NUM_RING_RX_SW_STATS +
 	     bnxt_get_num_tpa_ring_stats(bp);
 	tx = NUM_RING_TX_HW_STATS + bnxt_get_num_tx_sw_push_stats(bp) +
-		bnxt_get_num_txtime_sw_stats(bp);
+		NUM_RING_TX_SW_STATS + bnxt_get_num_txtime_sw_stats(bp);
 	cmn = NUM_RING_CMN_SW_STATS;
 	xsk = BNXT_NUM_XSK_STATS;
 
@@ -798,6 +978,7 @@ static int bnxt_get_num_stats(struct bnxt *bp)
 	int len;
 
 	num_stats += BNXT_NUM_RING_ERR_STATS;
+	num_stats += BNXT_NUM_NTP_FLTR_STATS;
 
 	if (bp->ktls_info)
 		num_stats += BNXT_NUM_KTLS_STATS;
@@ -877,6 +1058,22 @@ static bool is_tx_ring(struct bnxt *bp, int ring_num)
 	return false;
 }
 
+static u32 bnxt_get_ntp_fltr_stats(struct bnxt *bp, u64 *buf, u32 j)
+{
+	atomic64_t *counters = bp->ntp_fltr_counters;
+	u64 installs, lat;
+
+	installs = atomic64_read(&counters[BNXT_NTP_FLTR_INSTALL]);
+	lat = atomic64_read(&counters[BNXT_NTP_FLTR_LAT_TOTAL_US]);
+	buf[j++] = installs;
+	buf[j++] = atomic64_read(&counters[BNXT_NTP_FLTR_INSTALL_ERR]);
+	buf[j++] = atomic64_read(&counters[BNXT_NTP_FLTR_EXPIRE]);
+	buf[j++] = atomic64_read(&counters[BNXT_NTP_FLTR_BACKLOG_DROP]);
+	buf[j++] = installs ? div64_u64(lat, installs) : 0;
+	buf[j++] = atomic64_read(&counters[BNXT_NTP_FLTR_LAT_MAX_US]);
+	return j;
+}
+
 static void bnxt_get_ethtool_stats(struct net_device *dev,
 				   struct ethtool_stats *stats, u64 *buf)
 {
@@ -932,6 +1129,10 @@ skip_tpa_ring_stats:
 			for (k = 0; k < bnxt_get_num_tx_sw_push_stats(bp); j++, k++)
 				buf[j] = sw[k];
 
+			sw = (u64 *)&cpr->sw_stats->tx_sw;
+			for (k = 0; k < NUM_RING_TX_SW_STATS; j++, k++)
+				buf[j] = sw[k];
+
 			sw = (u64 *)&cpr->sw_stats->txtime;
 			if (is_tx_ring(bp, i)) {
 				for (k = 0; k < bnxt_get_num_txtime_sw_stats(bp); j++, k++)
@@ -957,6 +1158,8 @@ skip_ring_stats:
 	for (i = 0; i < BNXT_NUM_RING_ERR_STATS; i++, j++, curr++, prev++)
 		buf[j] = *curr + *prev;
 
+	j = bnxt_get_ntp_fltr_stats(bp, buf, j);
+
 	if (bp->ktls_info) {
 		struct bnxt_ktls_info *ktls = bp->ktls_info;
 
@@ -1121,6 +1324,13 @@ skip_tpa_stats:
 					buf += ETH_GSTRING_LEN;
 				}
 
+				num_str = NUM_RING_TX_SW_STATS;
+				for (j = 0; j < num_str; j++) {
+					sprintf(buf, "[%d]: %s", i,
+						bnxt_tx_sw_stats_str[j]);
+					buf += ETH_GSTRING_LEN;
+				}
+
 				num_str = bnxt_get_num_txtime_sw_stats(bp);
 				for (j = 0; j < num_str; j++) {
 					sprintf(buf, "[%d]: %s", i,
@@ -1144,6 +1354,10 @@ skip_tpa_stats:
 			strcpy(buf, bnxt_ring_err_stats_arr[i]);
 			buf += ETH_GSTRING_LEN;
 		}
+		for (i = 0; i < BNXT_NUM_NTP_FLTR_STATS; i++) {
+			strcpy(buf, bnxt_ntp_fltr_stats[i]);
+			buf += ETH_GSTRING_LEN;
+		}
 		if (bp->ktls_info) {
 			for (i = 0; i < BNXT_NUM_KTLS_STATS; i++) {
 				strcpy(buf, bnxt_ktls_stats[i]);
@@ -1253,6 +1467,13 @@ skip_gen_stats:
 	}
 }
 
+#ifdef HAVE_ETHTOOL_RING_HDS_THRS
+#define BNXT_SUPPORTED_RING_PARAMS	(ETHTOOL_RING_USE_TCP_DATA_SPLIT | \
+					 ETHTOOL_RING_USE_HDS_THRS)
+#else
+#define BNXT_SUPPORTED_RING_PARAMS	ETHTOOL_RING_USE_TCP_DATA_SPLIT
+#endif
+
 static void bnxt_get_ringparam(struct net_device *dev,
 			       struct ethtool_ringparam *ering,
 			       struct kernel_ethtool_ringparam *kernel_ering,
@@ -1263,16 +1484,20 @@ static void bnxt_get_ringparam(struct net_device *dev,
 	if (bp->flags & BNXT_FLAG_AGG_RINGS) {
 		ering->rx_max_pending = BNXT_MAX_RX_DESC_CNT_JUM_ENA;
 		ering->rx_jumbo_max_pending = BNXT_MAX_RX_JUM_DESC_CNT;
-#ifdef HAVE_ETHTOOL_TCP_DATA_SPLIT
-		kernel_ering->tcp_data_split = ETHTOOL_TCP_DATA_SPLIT_ENABLED;
-#endif
 	} else {
 		ering->rx_max_pending = BNXT_MAX_RX_DESC_CNT;
 		ering->rx_jumbo_max_pending = 0;
+	}
 #ifdef HAVE_ETHTOOL_TCP_DATA_SPLIT
+	if (BNXT_HDS_ACTIVE(bp))
+		kernel_ering->tcp_data_split = ETHTOOL_TCP_DATA_SPLIT_ENABLED;
+	else
 		kernel_ering->tcp_data_split = ETHTOOL_TCP_DATA_SPLIT_DISABLED;
 #endif
-	}
+#ifdef HAVE_ETHTOOL_RING_HDS_THRS
+	kernel_ering->hds_thresh = bp->hds_thresh;
+	kernel_ering->hds_thresh_max = BNXT_HDS_THRESHOLD_MAX;
+#endif
 	ering->tx_max_pending = BNXT_MAX_TX_DESC_CNT;
 
 	ering->rx_pending = bp->rx_ring_size;
@@ -1286,17 +1511,50 @@ static int bnxt_set_ringparam(struct net_device *dev,
 			      struct netlink_ext_ack *extack)
 {
 	struct bnxt *bp = netdev_priv(dev);
+	u16 hds_thresh = bp->hds_thresh;
+	u8 hds_cfg = bp->hds_cfg;
 
 	if ((ering->rx_pending > BNXT_MAX_RX_DESC_CNT) ||
 	    (ering->tx_pending > BNXT_MAX_TX_DESC_CNT) ||
 	    (ering->tx_pending < BNXT_MIN_TX_DESC_CNT))
 		return -EINVAL;
 
+#ifdef HAVE_ETHTOOL_RING_USE_TCP_DATA_SPLIT
+	/* The core passes back what we reported when the user did not ask
+	 * for a change, so only act on a different value.
+	 */
+	if (kernel_ering->tcp_data_split == ETHTOOL_TCP_DATA_SPLIT_ENABLED &&
+	    !BNXT_HDS_ACTIVE(bp)) {
+		if (BNXT_RX_PAGE_MODE(bp)) {
+			NL_SET_ERR_MSG_MOD(extack, "tcp-data-split is disallowed when XDP is attached");
+			return -EINVAL;
+		}
+		if (bp->flags & BNXT_FLAG_NO_AGG_RINGS) {
+			NL_SET_ERR_MSG_MOD(extack, "tcp-data-split needs aggregation rings");
+			return -EOPNOTSUPP;
+		}
+		hds_cfg = BNXT_HDS_ON;
+	} else if (kernel_ering->tcp_data_split ==
+		   ETHTOOL_TCP_DATA_SPLIT_DISABLED && BNXT_HDS_ACTIVE(bp)) {
+		hds_cfg = BNXT_HDS_OFF;
+	} else if (kernel_ering->tcp_data_split ==
+		   ETHTOOL_TCP_DATA_SPLIT_UNKNOWN) {
+		hds_cfg = BNXT_HDS_AUTO;
+	}
+#endif
+#ifdef HAVE_ETHTOOL_RING_HDS_THRS
+	if (kernel_ering->hds_thresh > BNXT_HDS_THRESHOLD_MAX)
+		return -EINVAL;
+	hds_thresh = kernel_ering->hds_thresh;
+#endif
+
 	if (netif_running(dev))
 		bnxt_close_nic(bp, false, false);
 
 	bp->rx_ring_size = ering->rx_pending;
 	bp->tx_ring_size = ering->tx_pending;
+	bp->hds_cfg = hds_cfg;
+	bp->hds_thresh = hds_thresh;
 	bnxt_set_ring_params(bp);
 
 	if (netif_running(dev))
@@ -1473,6 +1731,7 @@ static int bnxt_set_channels(struct net_device *dev,
 		bp->tx_nr_rings_per_tc = channel->tx_count;
 	}
 	bp->tx_nr_rings_xdp = tx_xdp;
+	bp->xdp_saved_rx_rings = 0;
 	bp->tx_nr_rings = bp->tx_nr_rings_per_tc + tx_xdp;
 	if (tcs > 1)
 		bp->tx_nr_rings = bp->tx_nr_rings_per_tc * tcs + tx_xdp;
@@ -1558,7 +1817,7 @@ static int bnxt_grxclsrlall(struct bnxt *bp, struct ethtool_rxnfc *cmd,
 					  BNXT_L2_FLTR_HASH_SIZE, rule_locs, 0,
 					  cmd->rule_cnt);
 	cmd->rule_cnt = bnxt_get_all_fltr_ids_rcu(bp, bp->ntp_fltr_hash_tbl,
-						  BNXT_NTP_FLTR_HASH_SIZE,
+						  bp->ntp_fltr_hash_size,
 						  rule_locs, count,
 						  cmd->rule_cnt);
 	rcu_read_unlock();
@@ -1610,7 +1869,7 @@ static int bnxt_grxclsrule(struct bnxt *bp, struct ethtool_rxnfc *cmd)
 		return 0;
 	}
 	fltr_base = bnxt_get_one_fltr_rcu(bp, bp->ntp_fltr_hash_tbl,
-					  BNXT_NTP_FLTR_HASH_SIZE,
+					  bp->ntp_fltr_hash_size,
 					  fs->location);
 	if (!fltr_base) {
 		rcu_read_unlock();
@@ -2065,7 +2324,7 @@ static int bnxt_srxclsrldel(struct bnxt *bp, struct ethtool_rxnfc *cmd)
 		return 0;
 	}
 	fltr_base = bnxt_get_one_fltr_rcu(bp, bp->ntp_fltr_hash_tbl,
-					  BNXT_NTP_FLTR_HASH_SIZE,
+					  bp->ntp_fltr_hash_size,
 					  fs->location);
 	if (!fltr_base) {
 		rcu_read_unlock();
@@ -6123,6 +6382,37 @@ static int bnxt_set_priv_flags(struct net_device *dev, u32 flags)
 		bp->ipv6_flow_lbl_rss_en = 0;
 	}
 
+	/* The timed BD changes the TX ring BD budget, so reopen to apply it
+	 * with TX stopped.
+	 */
+	if (flags & (1 << BNXT_PRIV_FLAG_TX_EDT)) {
+#if defined(HAVE_ETF_QOPT_OFFLOAD)
+		if (!bnxt_tx_edt_supported(bp))
+			return -EOPNOTSUPP;
+		reload |= !bp->tx_edt;
+		bp->tx_edt = 1;
+#else
+		return -EOPNOTSUPP;
+#endif
+	} else {
+		reload |= !!bp->tx_edt;
+		bp->tx_edt = 0;
+	}
+#ifdef HAVE_MAX_PACING_OFFLOAD_HORIZON
+	/* Lets fq hand packets due within the horizon straight to the ring */
+	dev->max_pacing_offload_horizon =
+		bp->tx_edt ? BNXT_TX_EDT_HORIZON_NS : 0;
+#endif
+
+	/* Takes effect on the next NAPI poll */
+	bp->rx_prefetch_en = !!(flags & (1 << BNXT_PRIV_FLAG_RX_PREFETCH));
+	bnxt_set_rx_copybreak_adapt(bp,
+		!!(flags & (1 << BNXT_PRIV_FLAG_RX_COPYBREAK_ADAPT)));
+	/* The TPA level is stepped, or restored, by the periodic timer */
+	bp->tpa_adapt = !!(flags & (1 << BNXT_PRIV_FLAG_TPA_ADAPT));
+	/* Applied the next time an XDP program is attached */
+	bp->xdp_tx_per_cpu = !!(flags & (1 << BNXT_PRIV_FLAG_XDP_TX_PER_CPU));
+
 	if (reload && netif_running(dev)) {
 		bnxt_close_nic(bp, true, false);
 		rc = bnxt_open_nic(bp, true, false);
@@ -6145,6 +6435,21 @@ static u32 bnxt_get_priv_flags(struct net_device *dev)
 	if (bp->ipv6_flow_lbl_rss_en)
 		flags |= 1 << BNXT_PRIV_FLAG_RSS_IPV6_FLOW_LABEL_EN;
 
+	if (bp->rx_prefetch_en)
+		flags |= 1 << BNXT_PRIV_FLAG_RX_PREFETCH;
+
+	if (bp->rx_copybreak_adapt)
+		flags |= 1 << BNXT_PRIV_FLAG_RX_COPYBREAK_ADAPT;
+
+	if (bp->tpa_adapt)
+		flags |= 1 << BNXT_PRIV_FLAG_TPA_ADAPT;
+
+	if (bp->xdp_tx_per_cpu)
+		flags |= 1 << BNXT_PRIV_FLAG_XDP_TX_PER_CPU;
+
+	if (bp->tx_edt)
+		flags |= 1 << BNXT_PRIV_FLAG_TX_EDT;
+
 	return flags;
 }
 
@@ -6181,6 +6486,7 @@ const struct ethtool_ops bnxt_ethtool_ops = {
 					  ETHTOOL_COALESCE_MAX_FRAMES_IRQ |
 					  ETHTOOL_COALESCE_STATS_BLOCK_USECS |
 					  ETHTOOL_COALESCE_USE_ADAPTIVE_RX |
+					  ETHTOOL_COALESCE_USE_ADAPTIVE_TX |
 					  ETHTOOL_COALESCE_USE_CQE,
 #endif
 #ifdef HAVE_ETHTOOL_LINK_KSETTINGS
@@ -6211,12 +6517,16 @@ const struct ethtool_ops bnxt_ethtool_ops = {
 	.set_coalesce		= bnxt_set_coalesce,
 #ifdef HAVE_ETHTOOL_GET_PER_QUEUE_COAL
 	.get_per_queue_coalesce = bnxt_get_per_queue_coalesce,
+	.set_per_queue_coalesce = bnxt_set_per_queue_coalesce,
 #endif
 	.get_msglevel		= bnxt_get_msglevel,
 	.set_msglevel		= bnxt_set_msglevel,
 	.get_sset_count		= bnxt_get_sset_count,
 	.get_strings		= bnxt_get_strings,
 	.get_ethtool_stats	= bnxt_get_ethtool_stats,
+#ifdef HAVE_ETHTOOL_RING_USE_TCP_DATA_SPLIT
+	.supported_ring_params	= BNXT_SUPPORTED_RING_PARAMS,
+#endif
 	.set_ringparam		= bnxt_set_ringparam,
 	.get_ringparam		= bnxt_get_ringparam,
 #if defined(ETHTOOL_GCHANNELS) && !defined(GET_ETHTOOL_OP_EXT)
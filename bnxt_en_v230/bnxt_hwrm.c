@@ -463,8 +463,24 @@ hwrm_wait_must_abort(struct bnxt *bp, u32 req_type, u32 *fw_status)
 	return *fw_status && !BNXT_FW_IS_HEALTHY(*fw_status);
 }
 
+static void hwrm_update_stats(struct bnxt *bp, u32 req_type, u64 start,
+			      u64 locked, u64 doorbell, u64 resp)
+{
+	struct bnxt_hwrm_type_stats *stats;
+
+	if (!bp->hwrm_stats)
+		return;
+
+	stats = &bp->hwrm_stats[min_t(u32, req_type, BNXT_HWRM_STATS_MAX_TYPE)];
+	atomic64_inc(&stats->count);
+	atomic64_add(locked - start, &stats->lock_ns);
+	atomic64_add(resp - doorbell, &stats->fw_ns);
+	atomic64_add(ktime_get_ns() - resp + doorbell - locked, &stats->drv_ns);
+}
+
 static int __hwrm_send(struct bnxt *bp, struct bnxt_hwrm_ctx *ctx)
 {
+	u64 t_start = ktime_get_ns(), t_locked = 0, t_doorbell = 0, t_resp = 0;
 	u32 doorbell_offset = BNXT_GRCPF_REG_CHIMP_COMM_TRIGGER;
 	enum bnxt_hwrm_chnl dst = BNXT_HWRM_CHNL_CHIMP;
 	u32 bar_offset = BNXT_GRCPF_REG_CHIMP_COMM;
@@ -519,6 +535,7 @@ static int __hwrm_send(struct bnxt *bp, struct bnxt_hwrm_ctx *ctx)
 		rc = -ENOMEM;
 		goto exit;
 	}
+	t_locked = ktime_get_ns();
 	ctx->req->seq_id = cpu_to_le16(token->seq_id);
 
 	if ((bp->fw_cap & BNXT_FW_CAP_SHORT_CMD) ||
@@ -546,6 +563,7 @@ static int __hwrm_send(struct bnxt *bp, struct bnxt_hwrm_ctx *ctx)
 
 	/* Ring channel doorbell */
 	writel(1, bp->bar0 + doorbell_offset);
+	t_doorbell = ktime_get_ns();
 
 	hwrm_req_dbg(bp, ctx->req);
 
@@ -680,6 +698,8 @@ static int __hwrm_send(struct bnxt *bp, struct bnxt_hwrm_ctx *ctx)
 		}
 	}
 
+	t_resp = ktime_get_ns();
+
 	/* Zero valid bit for compatibility.  Valid bit in an older spec
 	 * may become a new field in a newer spec.  We must make sure that
 	 * a new field not implemented by old spec will read zero.
@@ -704,6 +724,9 @@ exit:
 		ctx->flags |= BNXT_HWRM_INTERNAL_RESP_DIRTY;
 	else
 		__hwrm_ctx_drop(bp, ctx);
+	if (t_resp)
+		hwrm_update_stats(bp, req_type, t_start, t_locked, t_doorbell,
+				  t_resp);
 	return rc;
 }
 
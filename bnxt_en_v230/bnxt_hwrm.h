@@ -56,6 +56,22 @@ struct bnxt_hwrm_wait_token {
 
 void hwrm_update_token(struct bnxt *bp, u16 seq, enum bnxt_hwrm_wait_state s);
 
+/* Time spent per HWRM request type.  lock_ns is the time waiting for
+ * the HWRM channel (hwrm_cmd_lock), drv_ns is the CPU time the driver
+ * spends posting and consuming the message once it owns the channel,
+ * fw_ns is the time from ringing the doorbell until the response is
+ * valid.  Request types at or above BNXT_HWRM_STATS_MAX_TYPE share the
+ * last slot.
+ */
+#define BNXT_HWRM_STATS_MAX_TYPE	0x400
+
+struct bnxt_hwrm_type_stats {
+	atomic64_t	count;
+	atomic64_t	lock_ns;
+	atomic64_t	drv_ns;
+	atomic64_t	fw_ns;
+};
+
 #define BNXT_HWRM_MAX_REQ_LEN		(bp->hwrm_max_req_len)
 #define BNXT_HWRM_SHORT_REQ_LEN		sizeof(struct hwrm_short_input)
 #define SHORT_HWRM_CMD_TIMEOUT		20
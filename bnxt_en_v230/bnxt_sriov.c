@@ -1330,7 +1330,9 @@ static int bnxt_sriov_enable(struct bnxt *bp, int *num_vfs)
 
 		if (netif_running(bp->dev)) {
 			bp->sriov_cfg = false;
+			bnxt_netdev_lock(bp->dev);
 			bnxt_close_nic(bp, true, false);
+			bnxt_netdev_unlock(bp->dev);
 			bp->sriov_cfg = true;
 		}
 
@@ -1343,8 +1345,11 @@ static int bnxt_sriov_enable(struct bnxt *bp, int *num_vfs)
 		/* Tell reserve rings to consider reservation again */
 		bnxt_set_ulp_msix_num(bp, 0);
 
-		if (netif_running(bp->dev))
+		if (netif_running(bp->dev)) {
+			bnxt_netdev_lock(bp->dev);
 			rc = bnxt_open_nic(bp, true, false);
+			bnxt_netdev_unlock(bp->dev);
+		}
 		hw_resc->max_nqs = max_nqs;
 		if (rc) {
 			rtnl_unlock();
@@ -1447,8 +1452,10 @@ void bnxt_sriov_disable(struct bnxt *bp)
 
 	/* Reclaim all resources for the PF. */
 	rtnl_lock();
+	bnxt_netdev_lock(bp->dev);
 	bnxt_set_dflt_ulp_stat_ctxs(bp);
 	bnxt_restore_pf_fw_resources(bp);
+	bnxt_netdev_unlock(bp->dev);
 	rtnl_unlock();
 }
 
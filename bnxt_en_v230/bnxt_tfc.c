@@ -141,6 +141,34 @@ int bnxt_alloc_tfc_mpc_info(struct bnxt *bp)
 	return 0;
 }
 
+static void bnxt_tfc_cmd_put(struct bnxt_tfc_mpc_info *tfc,
+			     struct bnxt_tfc_cmd_ctx *ctx)
+{
+	if (refcount_dec_and_test(&ctx->refs))
+		kmem_cache_free(tfc->mpc_cache, ctx);
+}
+
+/* Spread the commands from different CPUs over all the MPC rings of the
+ * channel so that concurrent EM and action operations do not serialize
+ * on one ring and its tx_lock.
+ */
+static struct bnxt_tx_ring_info *
+bnxt_tfc_mpc_txr(struct bnxt_mpc_info *mpc, u32 chnl_id)
+{
+	int type, count;
+
+	if (chnl_id == RING_ALLOC_REQ_MPC_CHNLS_TYPE_TE_CFA)
+		type = BNXT_MPC_TE_CFA_TYPE;
+	else
+		type = BNXT_MPC_RE_CFA_TYPE;
+
+	count = mpc->mpc_ring_count[type];
+	if (!count || !mpc->mpc_rings[type])
+		return NULL;
+
+	return &mpc->mpc_rings[type][raw_smp_processor_id() % count];
+}
+
 int bnxt_mpc_send(struct bnxt *bp,
 		  struct bnxt_mpc_mbuf *in_msg,
 		  struct bnxt_mpc_mbuf *out_msg,
@@ -148,21 +176,21 @@ int bnxt_mpc_send(struct bnxt *bp,
 {
 	struct bnxt_tfc_mpc_info *tfc = (struct bnxt_tfc_mpc_info *)bp->tfc_info;
 	struct bnxt_mpc_info *mpc = bp->mpc_info;
-	struct bnxt_tfc_cmd_ctx *ctx = NULL;
-	unsigned long tmo_left, handle = 0;
+	struct bnxt_tfc_cmd_ctx *ctx;
 	struct bnxt_tx_ring_info *txr;
 	uint tmo = BNXT_MPC_TIMEOUT;
+	unsigned long tmo_left;
 	int retry = 0;
 	int rc = 0;
 
 	if (!mpc || !tfc) {
 		netdev_dbg(bp->dev, "%s: mpc[%p], tfc[%p]\n", __func__, mpc, tfc);
-		return -1;
+		return -EINVAL;
 	}
 
 	if (out_msg->cmp_type != MPC_CMP_TYPE_MID_PATH_SHORT &&
 	    out_msg->cmp_type != MPC_CMP_TYPE_MID_PATH_LONG)
-		return -1;
+		return -EINVAL;
 
 	do {
 		atomic_inc(&tfc->pending);
@@ -185,35 +213,32 @@ int bnxt_mpc_send(struct bnxt *bp,
 		return -EAGAIN;
 	}
 
-	if (in_msg->chnl_id == RING_ALLOC_REQ_MPC_CHNLS_TYPE_TE_CFA)
-		txr = &mpc->mpc_rings[BNXT_MPC_TE_CFA_TYPE][0];
-	else
-		txr = &mpc->mpc_rings[BNXT_MPC_RE_CFA_TYPE][0];
-
+	txr = bnxt_tfc_mpc_txr(mpc, in_msg->chnl_id);
 	if (!txr) {
 		netdev_err(bp->dev, "%s: No Tx rings\n", __func__);
 		rc = -EINVAL;
 		goto xmit_done;
 	}
 
-	if (tmo) {
-		ctx = kmem_cache_alloc(tfc->mpc_cache, GFP_KERNEL);
-		if (!ctx) {
-			rc = -ENOMEM;
-			goto xmit_done;
-		}
-		init_completion(&ctx->cmp);
-		handle = (unsigned long)ctx;
-		ctx->tfc_cmp.opaque = *opaque;
-		might_sleep();
+	ctx = kmem_cache_alloc(tfc->mpc_cache, GFP_KERNEL);
+	if (!ctx) {
+		rc = -ENOMEM;
+		goto xmit_done;
 	}
+	init_completion(&ctx->cmp);
+	/* One reference for us, one for the completion handler */
+	refcount_set(&ctx->refs, 2);
+	ctx->tfc_cmp.opaque = *opaque;
+	might_sleep();
 
 	spin_lock(&txr->tx_lock);
 	rc = bnxt_start_xmit_mpc(bp, txr, in_msg->msg_data,
-				 in_msg->msg_size, handle);
+				 in_msg->msg_size, (unsigned long)ctx);
 	spin_unlock(&txr->tx_lock);
-	if (rc || !tmo)
-		goto xmit_done;
+	if (rc) {
+		refcount_dec(&ctx->refs);
+		goto ctx_put;
+	}
 
 	tmo_left = wait_for_completion_timeout(&ctx->cmp, msecs_to_jiffies(tmo));
 	if (!tmo_left) {
@@ -221,7 +246,7 @@ int bnxt_mpc_send(struct bnxt *bp,
 		netdev_warn(bp->dev, "TFC MP cmd %08x timed out\n",
 			    *((u32 *)in_msg->msg_data));
 		rc = -ETIMEDOUT;
-		goto xmit_done;
+		goto ctx_put;
 	}
 	if (TFC_CMPL_STATUS(&ctx->tfc_cmp) == TFC_CMPL_STATUS_OK) {
 		/* Copy response/completion back into out_msg */
@@ -233,9 +258,9 @@ int bnxt_mpc_send(struct bnxt *bp,
 		rc = -EIO;
 	}
 
+ctx_put:
+	bnxt_tfc_cmd_put(tfc, ctx);
 xmit_done:
-	if (ctx)
-		kmem_cache_free(tfc->mpc_cache, ctx);
 	atomic_dec(&tfc->pending);
 	return rc;
 }
@@ -264,4 +289,5 @@ void bnxt_tfc_mpc_cmp(struct bnxt *bp, u32 client, unsigned long handle,
 		memcpy(&ctx->tfc_cmp, cmpl[0].cmpl, len);
 	}
 	complete(&ctx->cmp);
+	bnxt_tfc_cmd_put(bp->tfc_info, ctx);
 }
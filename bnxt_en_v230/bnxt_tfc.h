@@ -11,6 +11,7 @@
 #define BNXT_TFC_H
 
 #include <linux/hashtable.h>
+#include <linux/refcount.h>
 #include "bnxt_mpc.h"
 
 struct bnxt_tfc_mpc_info {
@@ -115,8 +116,13 @@ struct tfc_cmpl {
 	(le16_to_cpu((tfc_cmpl)->client_status_type) &		\
 	TFC_CMPL_STATUS_MASK)
 
+/* The submitter and the posted command each hold a reference, so a
+ * completion that arrives after the submitter timed out never touches
+ * freed memory.
+ */
 struct bnxt_tfc_cmd_ctx {
 	struct completion cmp;
+	refcount_t refs;
 	struct tfc_cmpl tfc_cmp;
 };
 
@@ -889,6 +889,7 @@ void bnxt_vf_reps_destroy(struct bnxt *bp)
 	 * before proceeding with VF-rep cleanup.
 	 */
 	rtnl_lock();
+	bnxt_netdev_lock(bp->dev);
 	if (netif_running(bp->dev)) {
 		bnxt_close_nic(bp, false, false);
 		closed = true;
@@ -905,6 +906,7 @@ void bnxt_vf_reps_destroy(struct bnxt *bp)
 		bnxt_open_nic(bp, false, false);
 		bp->eswitch_mode = DEVLINK_ESWITCH_MODE_SWITCHDEV;
 	}
+	bnxt_netdev_unlock(bp->dev);
 	rtnl_unlock();
 
 	/* Need to call vf_reps_destroy() outside of rntl_lock
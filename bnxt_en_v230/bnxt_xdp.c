@@ -104,8 +104,9 @@ struct bnxt_sw_tx_bd *bnxt_xmit_bd(struct bnxt *bp,
 	prod = NEXT_TX(prod);
 	WRITE_ONCE(txr->tx_prod, prod);
 
-	/* Sync TX BD */
-	wmb();
+	/* No barrier per BD, callers batch BDs and issue wmb() once before
+	 * ringing the TX doorbell.
+	 */
 	return tx_buf;
 }
 
@@ -179,10 +180,18 @@ void bnxt_tx_int_xdp(struct bnxt *bp, struct bnxt_napi *bnapi, int budget)
 	u16 tx_cons = txr->tx_cons;
 	u16 last_tx_cons = tx_cons;
 	int i, frags, xsk_tx = 0;
+#ifdef HAVE_XDP_FRAME_BULK
+	struct xdp_frame_bulk bq;
+#endif
 
 	if (!budget)
 		return;
 
+#ifdef HAVE_XDP_FRAME_BULK
+	xdp_frame_bulk_init(&bq);
+	rcu_read_lock(); /* xdp_return_frame_bulk() */
+#endif
+
 	while (RING_TX(bp, tx_cons) != tx_hw_cons) {
 		tx_buf = &txr->tx_buf_ring[RING_TX(bp, tx_cons)];
 
@@ -193,7 +202,9 @@ void bnxt_tx_int_xdp(struct bnxt *bp, struct bnxt_napi *bnapi, int budget)
 					dma_unmap_addr(tx_buf, mapping),
 					dma_unmap_len(tx_buf, len),
 					DMA_TO_DEVICE);
-#ifdef HAVE_XDP_FRAME
+#ifdef HAVE_XDP_FRAME_BULK
+			xdp_return_frame_bulk(tx_buf->xdpf, &bq);
+#elif defined(HAVE_XDP_FRAME)
 			xdp_return_frame(tx_buf->xdpf);
 #endif
 			tx_buf->action = 0;
@@ -219,10 +230,17 @@ void bnxt_tx_int_xdp(struct bnxt *bp, struct bnxt_napi *bnapi, int budget)
 			xsk_tx++;
 		} else {
 			bnxt_sched_reset_txr(bp, txr, tx_cons);
-			return;
+			break;
 		}
 		tx_cons = NEXT_TX(tx_cons);
 	}
+#ifdef HAVE_XDP_FRAME_BULK
+	xdp_flush_frame_bulk(&bq);
+	rcu_read_unlock();
+#endif
+	if (RING_TX(bp, tx_cons) != tx_hw_cons)
+		return;
+
 	bnapi->events &= ~BNXT_TX_CMP_EVENT;
 	WRITE_ONCE(txr->tx_cons, tx_cons);
 
@@ -344,6 +362,7 @@ bool bnxt_rx_xdp(struct bnxt *bp, struct bnxt_rx_ring_info *rxr, u16 cons,
 		*event |= BNXT_TX_EVENT;
 		__bnxt_xmit_xdp(bp, txr, mapping + offset, *len,
 				NEXT_RX(rxr->rx_prod), xdp);
+		rxr->bnapi->cp_ring.sw_stats->cmn.xdp_tx_frames++;
 		bnxt_reuse_rx_data(rxr, cons, page);
 		return true;
 	case XDP_REDIRECT:
@@ -399,6 +418,7 @@ int bnxt_xdp_xmit(struct net_device *dev, int num_frames,
 	struct bnxt *bp = netdev_priv(dev);
 	struct bpf_prog *xdp_prog = READ_ONCE(bp->xdp_prog);
 	struct pci_dev *pdev = bp->pdev;
+	struct bnxt_sw_stats *sw_stats;
 	struct bnxt_tx_ring_info *txr;
 	dma_addr_t mapping;
 	int nxmit = 0;
@@ -416,8 +436,15 @@ int bnxt_xdp_xmit(struct net_device *dev, int num_frames,
 	if (READ_ONCE(txr->dev_state) == BNXT_DEV_STATE_CLOSING)
 		return -EINVAL;
 
-	if (static_branch_unlikely(&bnxt_xdp_locking_key))
-		spin_lock(&txr->tx_lock);
+	sw_stats = txr->bnapi->cp_ring.sw_stats;
+	if (static_branch_unlikely(&bnxt_xdp_locking_key)) {
+		bool contended = !spin_trylock(&txr->tx_lock);
+
+		if (contended)
+			spin_lock(&txr->tx_lock);
+		sw_stats->cmn.xdp_xmit_locked++;
+		sw_stats->cmn.xdp_xmit_lock_contended += contended;
+	}
 
 	for (i = 0; i < num_frames; i++) {
 		struct xdp_frame *xdp = frames[i];
@@ -434,11 +461,13 @@ int bnxt_xdp_xmit(struct net_device *dev, int num_frames,
 		__bnxt_xmit_xdp_redirect(bp, txr, mapping, xdp->len, xdp);
 		nxmit++;
 	}
+	sw_stats->cmn.xdp_xmit_frames += nxmit;
 
 	if (flags & XDP_XMIT_FLUSH) {
 		/* Sync BD data before updating doorbell */
 		wmb();
 		bnxt_db_write(bp, &txr->tx_db, txr->tx_prod);
+		sw_stats->cmn.xdp_xmit_db++;
 	}
 
 	if (static_branch_unlikely(&bnxt_xdp_locking_key))
@@ -453,6 +482,7 @@ int bnxt_xdp_xmit(struct net_device *dev, int num_frames,
 	struct bnxt *bp = netdev_priv(dev);
 	struct bpf_prog *xdp_prog = READ_ONCE(bp->xdp_prog);
 	struct pci_dev *pdev = bp->pdev;
+	struct bnxt_sw_stats *sw_stats;
 	struct bnxt_tx_ring_info *txr;
 	dma_addr_t mapping;
 	int drops = 0;
@@ -470,8 +500,15 @@ int bnxt_xdp_xmit(struct net_device *dev, int num_frames,
 	if (READ_ONCE(txr->dev_state) == BNXT_DEV_STATE_CLOSING)
 		return -EINVAL;
 
-	if (static_branch_unlikely(&bnxt_xdp_locking_key))
-		spin_lock(&txr->tx_lock);
+	sw_stats = txr->bnapi->cp_ring.sw_stats;
+	if (static_branch_unlikely(&bnxt_xdp_locking_key)) {
+		bool contended = !spin_trylock(&txr->tx_lock);
+
+		if (contended)
+			spin_lock(&txr->tx_lock);
+		sw_stats->cmn.xdp_xmit_locked++;
+		sw_stats->cmn.xdp_xmit_lock_contended += contended;
+	}
 
 	for (i = 0; i < num_frames; i++) {
 		struct xdp_frame *xdp = frames[i];
@@ -492,11 +529,13 @@ int bnxt_xdp_xmit(struct net_device *dev, int num_frames,
 		}
 		__bnxt_xmit_xdp_redirect(bp, txr, mapping, xdp->len, xdp);
 	}
+	sw_stats->cmn.xdp_xmit_frames += num_frames - drops;
 
 	if (flags & XDP_XMIT_FLUSH) {
 		/* Sync BD data before updating doorbell */
 		wmb();
 		bnxt_db_write(bp, &txr->tx_db, txr->tx_prod);
+		sw_stats->cmn.xdp_xmit_db++;
 	}
 
 	if (static_branch_unlikely(&bnxt_xdp_locking_key))
@@ -507,11 +546,43 @@ int bnxt_xdp_xmit(struct net_device *dev, int num_frames,
 #endif /* LINUX_VERSION_CODE >= KERNEL_VERSION(5,13,0) */
 #endif
 
+static bool bnxt_xdp_rss_tbl_ok(struct bnxt *bp, int rx)
+{
+	return bnxt_get_nr_rss_ctxs(bp, rx) ==
+	       bnxt_get_nr_rss_ctxs(bp, bp->rx_nr_rings) ||
+	       !netif_is_rxfh_configured(bp->dev);
+}
+
+/* Each XDP TX ring is serviced by the NAPI of the RX ring with the same
+ * index, so giving every CPU its own XDP TX ring means growing the
+ * combined channels.  Go as far as the ring and MSI-X resources allow,
+ * backing off towards the current count if the reservation check fails.
+ */
+static int bnxt_xdp_rx_rings_per_cpu(struct bnxt *bp, int tc)
+{
+	int rx = bp->rx_nr_rings;
+	int max_rx, max_tx, want;
+
+	if (bnxt_get_max_rings(bp, &max_rx, &max_tx, true))
+		return rx;
+
+	want = min_t(int, num_possible_cpus(), max_rx);
+	while (want > rx) {
+		if (bnxt_xdp_rss_tbl_ok(bp, want) &&
+		    !bnxt_check_rings(bp, bp->tx_nr_rings_per_tc, want, true,
+				      tc, want))
+			return want;
+		want = rx + (want - rx) / 2;
+	}
+	return rx;
+}
+
 /* Under rtnl_lock */
 static int bnxt_xdp_set(struct bnxt *bp, struct bpf_prog *prog)
 {
 	struct net_device *dev = bp->dev;
 	int tx_xdp = 0, tx_cp, rc, tc;
+	int rx = bp->rx_nr_rings;
 	struct bpf_prog *old;
 
 #ifndef HAVE_XDP_MULTI_BUFF
@@ -529,14 +600,27 @@ static int bnxt_xdp_set(struct bnxt *bp, struct bpf_prog *prog)
 		netdev_warn(dev, "ethtool rx/tx channels must be combined to support XDP.\n");
 		return -EOPNOTSUPP;
 	}
-	if (prog)
-		tx_xdp = bp->rx_nr_rings;
-
 	tc = bp->num_tc;
 	if (!tc)
 		tc = 1;
-	rc = bnxt_check_rings(bp, bp->tx_nr_rings_per_tc, bp->rx_nr_rings,
-			      true, tc, tx_xdp);
+	if (prog) {
+		if (!bp->tx_nr_rings_xdp && bp->xdp_tx_per_cpu)
+			rx = bnxt_xdp_rx_rings_per_cpu(bp, tc);
+		tx_xdp = rx;
+	} else if (bp->xdp_saved_rx_rings &&
+		   bnxt_xdp_rss_tbl_ok(bp, bp->xdp_saved_rx_rings)) {
+		/* Give back the channels added at attach time, unless the
+		 * user has since added ntuple filters or RSS contexts that
+		 * shrinking would delete.
+		 */
+		if (list_empty(&bp->usr_fltr_list) && !bp->num_rss_ctx)
+			rx = bp->xdp_saved_rx_rings;
+		else
+			netdev_info(dev, "Keeping %d channels, ntuple filters or RSS contexts are configured\n",
+				    bp->rx_nr_rings);
+	}
+	rc = bnxt_check_rings(bp, bp->tx_nr_rings_per_tc, rx, true, tc,
+			      tx_xdp);
 	if (rc) {
 		netdev_warn(dev, "Unable to reserve enough TX rings to support XDP.\n");
 		return rc;
@@ -544,6 +628,14 @@ static int bnxt_xdp_set(struct bnxt *bp, struct bpf_prog *prog)
 	if (netif_running(dev))
 		bnxt_close_nic(bp, true, false);
 
+	if (rx != bp->rx_nr_rings) {
+		if (prog)
+			bp->xdp_saved_rx_rings = bp->rx_nr_rings;
+		bp->rx_nr_rings = rx;
+	}
+	if (!prog)
+		bp->xdp_saved_rx_rings = 0;
+
 	old = xchg(&bp->xdp_prog, prog);
 	if (old)
 		bpf_prog_put(old);
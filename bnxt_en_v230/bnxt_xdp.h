@@ -13,6 +13,27 @@
 
 DECLARE_STATIC_KEY_FALSE(bnxt_xdp_locking_key);
 
+/* XDP buffer with the RX completion it was built from, so that the XDP
+ * RX metadata kfuncs can read the hash, VLAN tag and timestamp.  It must
+ * fit in the xdp_buff_xsk private area for AF_XDP zero copy.
+ */
+struct bnxt_xdp_buff {
+	struct xdp_buff		xdp;
+	struct rx_cmp		*rxcmp;
+	struct rx_cmp_ext	*rxcmp1;
+};
+
+static inline void bnxt_xdp_buff_set_cmp(struct xdp_buff *xdp,
+					 struct rx_cmp *rxcmp,
+					 struct rx_cmp_ext *rxcmp1)
+{
+	struct bnxt_xdp_buff *bxdp = container_of(xdp, struct bnxt_xdp_buff,
+						  xdp);
+
+	bxdp->rxcmp = rxcmp;
+	bxdp->rxcmp1 = rxcmp1;
+}
+
 struct bnxt_sw_tx_bd *bnxt_xmit_bd(struct bnxt *bp,
 				   struct bnxt_tx_ring_info *txr,
 				   dma_addr_t mapping, u32 len,
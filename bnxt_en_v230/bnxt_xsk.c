@@ -61,79 +61,6 @@ int bnxt_xsk_wakeup(struct net_device *dev, u32 queue_id, u32 flags)
 	return 0;
 }
 
-static void bnxt_xsk_disable_rx_ring(struct bnxt *bp, u16 queue_id)
-{
-	struct bnxt_rx_ring_info *rxr;
-	struct bnxt_vnic_info *vnic;
-	struct bnxt_napi *bnapi;
-
-	rxr = &bp->rx_ring[queue_id];
-	bnapi = rxr->bnapi;
-	vnic = &bp->vnic_info[BNXT_VNIC_NTUPLE];
-
-#ifdef HAVE_XDP_RXQ_INFO
-	if (xdp_rxq_info_is_reg(&rxr->xdp_rxq))
-		xdp_rxq_info_unreg(&rxr->xdp_rxq);
-#endif
-	vnic->mru = 0;
-	bnxt_hwrm_vnic_update(bp, vnic, VNIC_UPDATE_REQ_ENABLES_MRU_VALID);
-	napi_disable(&bnapi->napi);
-	bnxt_free_one_rx_buf_ring(bp, rxr);
-	bnxt_hwrm_rx_ring_free(bp, rxr, 0);
-}
-
-static int bnxt_xsk_enable_rx_ring(struct bnxt *bp,  u16 queue_id)
-{
-	struct bnxt_rx_ring_info *rxr;
-	struct bnxt_vnic_info *vnic;
-	struct bnxt_napi *bnapi;
-	int rc, i;
-	u32 prod;
-
-	rxr = &bp->rx_ring[queue_id];
-	bnapi = rxr->bnapi;
-	vnic = &bp->vnic_info[BNXT_VNIC_NTUPLE];
-
-#ifdef HAVE_XDP_RXQ_INFO
-	rc = xdp_rxq_info_reg(&rxr->xdp_rxq, bp->dev, queue_id, 0);
-	if (rc < 0)
-		return rc;
-
-	rxr->xsk_pool = xsk_get_pool_from_qid(bp->dev, queue_id);
-	if (BNXT_RING_RX_ZC_MODE(rxr) && rxr->xsk_pool) {
-		rc = xdp_rxq_info_reg_mem_model(&rxr->xdp_rxq,
-						MEM_TYPE_XSK_BUFF_POOL, NULL);
-		xsk_pool_set_rxq_info(rxr->xsk_pool, &rxr->xdp_rxq);
-		netdev_dbg(bp->dev, "%s(): AF_XDP_ZC flag set for rxring:%d\n", __func__, queue_id);
-	} else {
-		rc = xdp_rxq_info_reg_mem_model(&rxr->xdp_rxq,
-						MEM_TYPE_PAGE_POOL, rxr->page_pool);
-		netdev_dbg(bp->dev, "%s(): AF_XDP_ZC flag RESET for rxring:%d\n",
-			   __func__, queue_id);
-	}
-#endif
-	rxr->rx_next_cons = 0;
-	bnxt_hwrm_rx_ring_alloc(bp, rxr, queue_id);
-
-	rxr->rx_prod = 0;
-	prod = rxr->rx_prod;
-	for (i = 0; i < bp->rx_ring_size; i++) {
-		if (bnxt_alloc_rx_data(bp, rxr, prod, GFP_KERNEL)) {
-			netdev_warn(bp->dev, "init'ed rx ring %d with %d/%d skbs only\n",
-				    queue_id, i, bp->rx_ring_size);
-			break;
-		}
-		prod = NEXT_RX(prod);
-	}
-	rxr->rx_prod = prod;
-	bnxt_db_write(bp, &rxr->rx_db, rxr->rx_prod);
-	napi_enable(&bnapi->napi);
-	vnic->mru = bp->dev->mtu + ETH_HLEN + VLAN_HLEN;
-	bnxt_hwrm_vnic_update(bp, vnic, VNIC_UPDATE_REQ_ENABLES_MRU_VALID);
-
-	return rc;
-}
-
 static bool bnxt_check_xsk_q_in_dflt_vnic(struct bnxt *bp, u16 queue_id)
 {
 	u16 tbl_size, i;
@@ -176,7 +103,6 @@ static int bnxt_xdp_enable_pool(struct bnxt *bp, struct xsk_buff_pool *pool,
 {
 	struct bpf_prog *xdp_prog = READ_ONCE(bp->xdp_prog);
 	struct device *dev = &bp->pdev->dev;
-	struct bnxt_rx_ring_info *rxr;
 	bool needs_reset;
 	int rc;
 
@@ -184,7 +110,6 @@ static int bnxt_xdp_enable_pool(struct bnxt *bp, struct xsk_buff_pool *pool,
 	if (rc)
 		return rc;
 
-	rxr = &bp->rx_ring[queue_id];
 	rc = xsk_pool_dma_map(pool, dev, DMA_ATTR_SKIP_CPU_SYNC | DMA_ATTR_WEAK_ORDERING);
 	if (rc) {
 		netdev_err(bp->dev, "Failed to map xsk pool\n");
@@ -203,9 +128,7 @@ static int bnxt_xdp_enable_pool(struct bnxt *bp, struct xsk_buff_pool *pool,
 	if (needs_reset) {
 		/* Check to differentiate b/n Tx/Rx only modes */
 		if (xsk_buff_can_alloc(pool, bp->rx_ring_size)) {
-			bnxt_xsk_disable_rx_ring(bp, queue_id);
-			rxr->flags |= BNXT_RING_FLAG_AF_XDP_ZC;
-			bnxt_xsk_enable_rx_ring(bp, queue_id);
+			rc = bnxt_restart_rx_queue(bp, queue_id);
 		} else {
 			struct bnxt_tx_ring_info *txr = &bp->tx_ring[queue_id];
 			struct bnxt_napi *bnapi;
@@ -223,7 +146,6 @@ static int bnxt_xdp_enable_pool(struct bnxt *bp, struct xsk_buff_pool *pool,
 static int bnxt_xdp_disable_pool(struct bnxt *bp, u16 queue_id)
 {
 	struct bpf_prog *xdp_prog = READ_ONCE(bp->xdp_prog);
-	struct bnxt_rx_ring_info *rxr;
 	struct bnxt_tx_ring_info *txr;
 	struct xsk_buff_pool *pool;
 	struct bnxt_napi *bnapi;
@@ -239,27 +161,26 @@ static int bnxt_xdp_disable_pool(struct bnxt *bp, u16 queue_id)
 		return 0;
 	}
 
-	rxr = &bp->rx_ring[queue_id];
 	txr = &bp->tx_ring[queue_id];
 
 	bnapi = bp->bnapi[queue_id];
 
-	bnxt_lock_napi(bnapi);
 	clear_bit(queue_id, bp->af_xdp_zc_qs);
-	xsk_pool_dma_unmap(pool, DMA_ATTR_SKIP_CPU_SYNC | DMA_ATTR_WEAK_ORDERING);
-
 	needs_reset = netif_running(bp->dev) && xdp_prog;
 
+	/* The restart stops and starts NAPI on its own, only the TX pool
+	 * pointer needs the NAPI lock.
+	 */
 	if (needs_reset) {
-		if (xsk_buff_can_alloc(pool, bp->rx_ring_size)) {
-			bnxt_xsk_disable_rx_ring(bp, queue_id);
-			rxr->flags &= ~BNXT_RING_FLAG_AF_XDP_ZC;
-			bnxt_xsk_enable_rx_ring(bp, queue_id);
-		}
+		if (xsk_buff_can_alloc(pool, bp->rx_ring_size))
+			bnxt_restart_rx_queue(bp, queue_id);
 	}
-	txr->xsk_pool = NULL;
 
+	bnxt_lock_napi(bnapi);
+	txr->xsk_pool = NULL;
 	bnxt_unlock_napi(bnapi);
+
+	xsk_pool_dma_unmap(pool, DMA_ATTR_SKIP_CPU_SYNC | DMA_ATTR_WEAK_ORDERING);
 	return 0;
 }
 
@@ -273,6 +194,81 @@ int bnxt_xdp_setup_pool(struct bnxt *bp, struct xsk_buff_pool *pool,
 		bnxt_xdp_disable_pool(bp, queue_id);
 }
 
+#ifdef HAVE_XSK_MULTI_BUFF
+bool bnxt_xsk_add_frag(struct xdp_buff *head, struct xdp_buff *frag)
+{
+#ifdef HAVE_XSK_BUFF_ADD_FRAG_HEAD
+	return xsk_buff_add_frag(head, frag);
+#else
+	struct skb_shared_info *sinfo = xdp_get_shared_info_from_buff(head);
+	u32 len = frag->data_end - frag->data;
+
+	if (!xdp_buff_has_frags(head)) {
+		sinfo->nr_frags = 0;
+		sinfo->xdp_frags_size = 0;
+		xdp_buff_set_frags_flag(head);
+	}
+	if (unlikely(sinfo->nr_frags == MAX_SKB_FRAGS))
+		return false;
+
+	__skb_fill_page_desc_noacc(sinfo, sinfo->nr_frags++,
+				   virt_to_page(frag->data),
+				   offset_in_page(frag->data), len);
+	sinfo->xdp_frags_size += len;
+	xsk_buff_add_frag(frag);
+	return true;
+#endif
+}
+
+/* Give the frags of a multi-buffer frame back to the pool.  The head
+ * buffer is left to the caller, which usually recycles it on the RX ring.
+ */
+void bnxt_xsk_free_frags(struct xdp_buff *xdp)
+{
+	struct xdp_buff *frag;
+
+	if (!xdp_buff_has_frags(xdp))
+		return;
+
+	while ((frag = xsk_buff_get_frag(xdp)))
+		xsk_buff_free(frag);
+	xdp_buff_clear_frags_flag(xdp);
+}
+
+/* XDP_PASS of a multi-buffer frame.  The frags belong to the umem, so copy
+ * the whole frame into a linear skb and release the frags.
+ */
+struct sk_buff *bnxt_xsk_copy_skb(struct bnxt_napi *bnapi,
+				  struct xdp_buff *xdp)
+{
+	struct skb_shared_info *sinfo = xdp_get_shared_info_from_buff(xdp);
+	unsigned int metasize = 0;
+	struct sk_buff *skb;
+	u32 i;
+
+#ifdef HAVE_XDP_DATA_META
+	metasize = xdp->data - xdp->data_meta;
+#endif
+	skb = napi_alloc_skb(&bnapi->napi, metasize + xdp_get_buff_len(xdp));
+	if (skb) {
+		skb_put_data(skb, xdp->data - metasize,
+			     metasize + xdp->data_end - xdp->data);
+		for (i = 0; i < sinfo->nr_frags; i++) {
+			skb_frag_t *frag = &sinfo->frags[i];
+
+			skb_put_data(skb, skb_frag_address(frag),
+				     skb_frag_size(frag));
+		}
+		if (metasize) {
+			skb_metadata_set(skb, metasize);
+			__skb_pull(skb, metasize);
+		}
+	}
+	bnxt_xsk_free_frags(xdp);
+	return skb;
+}
+#endif
+
 /* returns the following:
  * true    - packet consumed by XDP and new buffer is allocated.
  * false   - packet should be passed to the stack.
@@ -293,6 +289,9 @@ bool bnxt_rx_xsk(struct bnxt *bp, struct bnxt_rx_ring_info *rxr, u16 cons,
 	u32 offset;
 	u32 act;
 
+#ifdef HAVE_XDP_METADATA_OPS
+	XSK_CHECK_PRIV_TYPE(struct bnxt_xdp_buff);
+#endif
 	if (!xdp_prog)
 		return false;
 
@@ -332,6 +331,15 @@ bool bnxt_rx_xsk(struct bnxt *bp, struct bnxt_rx_ring_info *rxr, u16 cons,
 	bnapi = rxr->bnapi;
 	cpr = &bnapi->cp_ring;
 
+#ifdef HAVE_XSK_MULTI_BUFF
+	if (xdp_buff_has_frags(xdp)) {
+		cpr->sw_stats->xsk_stats.xsk_rx_mb_pkts++;
+		/* The TX ring only takes linear frames from the umem */
+		if (act == XDP_TX)
+			act = XDP_ABORTED;
+	}
+#endif
+
 	switch (act) {
 	case XDP_PASS:
 		return false;
@@ -355,6 +363,7 @@ bool bnxt_rx_xsk(struct bnxt *bp, struct bnxt_rx_ring_info *rxr, u16 cons,
 		/* Pass NULL as xdp->data here is buffer from the XSK pool i.e userspace */
 		__bnxt_xmit_xdp(bp, txr, mapping + offset, *len,
 				NEXT_RX(rxr->rx_prod), NULL);
+		rxr->bnapi->cp_ring.sw_stats->cmn.xdp_tx_frames++;
 		bnxt_reuse_rx_data(rxr, cons, xdp);
 		return true;
 
@@ -367,6 +376,9 @@ bool bnxt_rx_xsk(struct bnxt *bp, struct bnxt_rx_ring_info *rxr, u16 cons,
 		/* if we are unable to allocate a new buffer, abort and reuse */
 		if (bnxt_alloc_rx_data(bp, rxr, rxr->rx_prod, GFP_ATOMIC)) {
 			trace_xdp_exception(bp->dev, xdp_prog, act);
+#ifdef HAVE_XSK_MULTI_BUFF
+			bnxt_xsk_free_frags(xdp);
+#endif
 			bnxt_reuse_rx_data(rxr, cons, xdp);
 			cpr->sw_stats->xsk_stats.xsk_rx_alloc_fail++;
 			return true;
@@ -375,6 +387,9 @@ bool bnxt_rx_xsk(struct bnxt *bp, struct bnxt_rx_ring_info *rxr, u16 cons,
 		if (xdp_do_redirect(bp->dev, xdp, xdp_prog)) {
 			trace_xdp_exception(bp->dev, xdp_prog, act);
 			cpr->sw_stats->xsk_stats.xsk_rx_redirect_fail++;
+#ifdef HAVE_XSK_MULTI_BUFF
+			bnxt_xsk_free_frags(xdp);
+#endif
 			bnxt_reuse_rx_data(rxr, cons, xdp);
 			return true;
 		}
@@ -389,77 +404,141 @@ bool bnxt_rx_xsk(struct bnxt *bp, struct bnxt_rx_ring_info *rxr, u16 cons,
 		trace_xdp_exception(bp->dev, xdp_prog, act);
 		fallthrough;
 	case XDP_DROP:
+#ifdef HAVE_XSK_MULTI_BUFF
+		bnxt_xsk_free_frags(xdp);
+#endif
 		break;
 	}
 	return true;
 }
 
+static bool bnxt_xsk_eop(struct xdp_desc *desc)
+{
+#ifdef HAVE_XSK_MULTI_BUFF
+	return xsk_is_eop_desc(desc);
+#else
+	return true;
+#endif
+}
+
+/* Fill the TX BD at @prod for @desc.  On the last descriptor of a packet,
+ * complete the first BD at @first_prod with the BD count and return true.
+ */
+static bool bnxt_xsk_xmit_desc(struct bnxt *bp, struct bnxt_tx_ring_info *txr,
+			       struct xdp_desc *desc, u16 prod, u16 first_prod)
+{
+	struct xsk_buff_pool *pool = txr->xsk_pool;
+	struct bnxt_sw_tx_bd *tx_buf;
+	struct tx_bd *txbd;
+	dma_addr_t mapping;
+	u32 flags, bds;
+
+	mapping = xsk_buff_raw_get_dma(pool, desc->addr);
+	xsk_buff_raw_dma_sync_for_device(pool, mapping, desc->len);
+
+	tx_buf = &txr->tx_buf_ring[RING_TX(bp, prod)];
+	tx_buf->action = BNXT_XSK_TX;
+	dma_unmap_addr_set(tx_buf, mapping, mapping);
+	dma_unmap_len_set(tx_buf, len, desc->len);
+
+	flags = desc->len << TX_BD_LEN_SHIFT;
+	if (prod == first_prod)
+		flags |= bnxt_lhint_arr[desc->len >> 9];
+	if (bnxt_xsk_eop(desc))
+		flags |= TX_BD_FLAGS_PACKET_END;
+
+	txbd = &txr->tx_desc_ring[TX_RING(bp, prod)][TX_IDX(prod)];
+	txbd->tx_bd_len_flags_type = cpu_to_le32(flags);
+	txbd->tx_bd_haddr = cpu_to_le64(mapping);
+
+	if (!(flags & TX_BD_FLAGS_PACKET_END))
+		return false;
+
+	bds = (u16)(prod - first_prod) + 1;
+	txbd = &txr->tx_desc_ring[TX_RING(bp, first_prod)][TX_IDX(first_prod)];
+	txbd->tx_bd_len_flags_type |=
+		cpu_to_le32(bds << TX_BD_FLAGS_BD_CNT_SHIFT);
+	txbd->tx_bd_opaque = SET_TX_OPAQUE(bp, txr, first_prod, bds);
+	return true;
+}
+
+/* Pull up to @budget descriptors from the XSK TX ring in one batch, fill
+ * the BDs and ring the doorbell once.  With the batch API the pool only
+ * hands out whole packets, so a multi-buffer packet never straddles two
+ * calls.
+ */
 bool bnxt_xsk_xmit(struct bnxt *bp, struct bnxt_napi *bnapi, int budget)
 {
 	struct bnxt_tx_ring_info *txr = bnapi->tx_ring[0];
+	struct xsk_buff_pool *pool = txr->xsk_pool;
 	struct bnxt_cp_ring_info *cpr;
 	int cpu = smp_processor_id();
-	struct bnxt_sw_tx_bd *tx_buf;
 	struct netdev_queue *txq;
 	u16 prod = txr->tx_prod;
+	int xsk_tx = 0, mb_tx = 0;
 	bool xsk_more = true;
-	struct tx_bd *txbd;
-	dma_addr_t mapping;
-	int i, xsk_tx = 0;
-	int num_frags = 0;
-	u32 len, flags;
+	u32 max, nb_descs;
+#ifdef HAVE_XSK_TX_BATCH
+	u16 first_prod = prod;
+	struct xdp_desc *descs;
+	u32 i;
+#else
+	struct xdp_desc desc;
+#endif
 
 	cpr = &bnapi->cp_ring;
 	txq = netdev_get_tx_queue(bp->dev, txr->txq_index);
 
 	__netif_tx_lock(txq, cpu);
 
-	for (i = 0; i < budget; i++) {
-		struct xdp_desc desc;
-
-		if (bnxt_tx_avail(bp, txr) < 2) {
-			cpr->sw_stats->xsk_stats.xsk_tx_ring_full++;
-			xsk_more = false;
-			break;
+	max = bnxt_tx_avail(bp, txr);
+	if (max < 2) {
+		cpr->sw_stats->xsk_stats.xsk_tx_ring_full++;
+		__netif_tx_unlock(txq);
+		return false;
+	}
+	/* Keep one BD free, as the per descriptor loop used to */
+	max = min_t(u32, max - 1, budget);
+
+#ifdef HAVE_XSK_TX_BATCH
+	nb_descs = xsk_tx_peek_release_desc_batch(pool, max);
+	descs = pool->tx_descs;
+	for (i = 0; i < nb_descs; i++) {
+		if (bnxt_xsk_xmit_desc(bp, txr, &descs[i], prod, first_prod)) {
+			if (prod != first_prod)
+				mb_tx++;
+			first_prod = NEXT_TX(prod);
+			xsk_tx++;
 		}
-
-		if (!xsk_tx_peek_desc(txr->xsk_pool, &desc)) {
-			xsk_more = false;
+		prod = NEXT_TX(prod);
+	}
+#else
+	for (nb_descs = 0; nb_descs < max; nb_descs++) {
+		if (!xsk_tx_peek_desc(pool, &desc))
 			break;
-		}
-
-		mapping = xsk_buff_raw_get_dma(txr->xsk_pool, desc.addr);
-		len = desc.len;
-
-		xsk_buff_raw_dma_sync_for_device(txr->xsk_pool, mapping, desc.len);
-
-		tx_buf = &txr->tx_buf_ring[RING_TX(bp, prod)];
-		tx_buf->action = BNXT_XSK_TX;
-
-		txbd = &txr->tx_desc_ring[TX_RING(bp, prod)][TX_IDX(prod)];
-		flags = (len << TX_BD_LEN_SHIFT) | ((num_frags + 1) << TX_BD_FLAGS_BD_CNT_SHIFT) |
-			bnxt_lhint_arr[len >> 9];
-		txbd->tx_bd_len_flags_type = cpu_to_le32(flags);
-		txbd->tx_bd_opaque = SET_TX_OPAQUE(bp, txr, prod, 1 + num_frags);
-		txbd->tx_bd_haddr = cpu_to_le64(mapping);
-
-		dma_unmap_addr_set(tx_buf, mapping, mapping);
-		dma_unmap_len_set(tx_buf, len, len);
-
-		flags &= ~TX_BD_LEN;
-		txbd->tx_bd_len_flags_type = cpu_to_le32(((len) << TX_BD_LEN_SHIFT) |
-						flags | TX_BD_FLAGS_PACKET_END);
+		bnxt_xsk_xmit_desc(bp, txr, &desc, prod, prod);
 		prod = NEXT_TX(prod);
-		txr->tx_prod = prod;
 		xsk_tx++;
 	}
+#endif
 
-	if (xsk_tx) {
+	if (nb_descs < max) {
+		xsk_more = false;
+	} else if (max < budget) {
+		cpr->sw_stats->xsk_stats.xsk_tx_ring_full++;
+		xsk_more = false;
+	}
+
+	if (nb_descs) {
 		/* write the doorbell */
 		wmb();
-		xsk_tx_release(txr->xsk_pool);
+#ifndef HAVE_XSK_TX_BATCH
+		xsk_tx_release(pool);
+#endif
+		WRITE_ONCE(txr->tx_prod, prod);
 		bnxt_db_write(bp, &txr->tx_db, prod);
 		cpr->sw_stats->xsk_stats.xsk_tx_sent_pkts += xsk_tx;
+		cpr->sw_stats->xsk_stats.xsk_tx_mb_pkts += mb_tx;
 	}
 
 	__netif_tx_unlock(txq);
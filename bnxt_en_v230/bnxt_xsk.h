@@ -18,4 +18,14 @@ int bnxt_xsk_wakeup(struct net_device *dev, u32 queue_id, u32 flags);
 int bnxt_xdp_setup_pool(struct bnxt *bp, struct xsk_buff_pool *pool,
 			u16 queue_id);
 bool bnxt_xsk_xmit(struct bnxt *bp, struct bnxt_napi *bnapi, int budget);
+
+#ifdef HAVE_XSK_MULTI_BUFF
+/* Fits both the TX BD count field and MAX_SKB_FRAGS */
+#define BNXT_XSK_MAX_SEGS	16
+
+bool bnxt_xsk_add_frag(struct xdp_buff *head, struct xdp_buff *frag);
+void bnxt_xsk_free_frags(struct xdp_buff *xdp);
+struct sk_buff *bnxt_xsk_copy_skb(struct bnxt_napi *bnapi,
+				  struct xdp_buff *xdp);
+#endif
 #endif
@@ -32,10 +32,14 @@ int bnxt_ba_init(struct bitalloc *pool, int size, bool free)
 	if (free) {
 		pool->size = size;
 		pool->free_count = size;
+		pool->first_free = 0;
+		pool->last_free = size;
 		bitmap_set(pool->bitmap, 0, size);
 	} else {
 		pool->size = size;
 		pool->free_count = 0;
+		pool->first_free = size;
+		pool->last_free = 0;
 	}
 
 	return 0;
@@ -61,6 +65,9 @@ void bnxt_ba_deinit(struct bitalloc *pool)
  * bnxt_ba_alloc - Allocate a lowest free index
  * @pool:   Pointer to struct bitalloc
  *
+ * The search starts at the first_free hint instead of index 0, so a
+ * mostly allocated pool does not rescan its in-use prefix on every call.
+ *
  * Returns: -1 on failure, index on success
  */
 int bnxt_ba_alloc(struct bitalloc *pool)
@@ -70,12 +77,14 @@ int bnxt_ba_alloc(struct bitalloc *pool)
 	if (unlikely(!pool || !pool->bitmap || !pool->free_count))
 		return r;
 
-	r = find_first_bit(pool->bitmap, pool->size);
+	r = find_next_bit(pool->bitmap, pool->size, pool->first_free);
 	if (likely(r < pool->size)) {
 		clear_bit(r, pool->bitmap);
 		--pool->free_count;
+		pool->first_free = r + 1;
+		return r;
 	}
-	return r;
+	return -1;
 }
 
 /**
@@ -91,12 +100,14 @@ int bnxt_ba_alloc_reverse(struct bitalloc *pool)
 	if (unlikely(!pool || !pool->bitmap || !pool->free_count))
 		return r;
 
-	r = find_last_bit(pool->bitmap, pool->size);
-	if (likely(r < pool->size)) {
+	r = find_last_bit(pool->bitmap, pool->last_free);
+	if (likely(r < pool->last_free)) {
 		clear_bit(r, pool->bitmap);
 		--pool->free_count;
+		pool->last_free = r;
+		return r;
 	}
-	return r;
+	return -1;
 }
 
 /**
@@ -144,6 +155,10 @@ int bnxt_ba_free(struct bitalloc *pool, int index)
 
 	set_bit(index, pool->bitmap);
 	pool->free_count++;
+	if (index < pool->first_free)
+		pool->first_free = index;
+	if (index >= pool->last_free)
+		pool->last_free = index + 1;
 	return 0;
 }
 
@@ -12,6 +12,9 @@
 struct bitalloc {
 	u32		size;
 	u32		free_count;
+	/* No free index below first_free or at/above last_free */
+	u32		first_free;
+	u32		last_free;
 	unsigned long	*bitmap;
 };
 
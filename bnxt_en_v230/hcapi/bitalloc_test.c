@@ -0,0 +1,241 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright(c) 2026 Broadcom
+ * All rights reserved.
+ */
+#include <kunit/test.h>
+#include <linux/module.h>
+
+/* The allocator is not exported by bnxt_en, build a private copy */
+#include "bitalloc.c"
+
+/* Not a multiple of BITS_PER_LONG, so the last word is partial */
+#define BA_TEST_SIZE	70
+
+static void ba_test_init(struct kunit *test)
+{
+	struct bitalloc pool;
+
+	KUNIT_EXPECT_EQ(test, bnxt_ba_init(&pool, 0, true), -EINVAL);
+	KUNIT_EXPECT_EQ(test, bnxt_ba_init(&pool, BITALLOC_MAX_SIZE + 1, true),
+			-EINVAL);
+
+	KUNIT_ASSERT_EQ(test, bnxt_ba_init(&pool, BA_TEST_SIZE, true), 0);
+	KUNIT_EXPECT_EQ(test, bnxt_ba_free_count(&pool), BA_TEST_SIZE);
+	KUNIT_EXPECT_EQ(test, bnxt_ba_inuse_count(&pool), 0);
+	bnxt_ba_deinit(&pool);
+
+	KUNIT_ASSERT_EQ(test, bnxt_ba_init(&pool, BA_TEST_SIZE, false), 0);
+	KUNIT_EXPECT_EQ(test, bnxt_ba_free_count(&pool), 0);
+	KUNIT_EXPECT_EQ(test, bnxt_ba_inuse_count(&pool), BA_TEST_SIZE);
+	bnxt_ba_deinit(&pool);
+}
+
+static void ba_test_alloc_until_full(struct kunit *test)
+{
+	struct bitalloc pool;
+	int i;
+
+	KUNIT_ASSERT_EQ(test, bnxt_ba_init(&pool, BA_TEST_SIZE, true), 0);
+	for (i = 0; i < BA_TEST_SIZE; i++)
+		KUNIT_EXPECT_EQ(test, bnxt_ba_alloc(&pool), i);
+
+	KUNIT_EXPECT_EQ(test, bnxt_ba_free_count(&pool), 0);
+	KUNIT_EXPECT_EQ(test, bnxt_ba_alloc(&pool), -1);
+	KUNIT_EXPECT_EQ(test, bnxt_ba_alloc_reverse(&pool), -1);
+	KUNIT_EXPECT_EQ(test, bnxt_ba_alloc_index(&pool, 0), -1);
+
+	for (i = 0; i < BA_TEST_SIZE; i++)
+		KUNIT_EXPECT_EQ(test, bnxt_ba_free(&pool, i), 0);
+	KUNIT_EXPECT_EQ(test, bnxt_ba_free_count(&pool), BA_TEST_SIZE);
+	KUNIT_EXPECT_EQ(test, bnxt_ba_alloc(&pool), 0);
+	bnxt_ba_deinit(&pool);
+}
+
+/* Frees below first_free must pull the hint back, or bnxt_ba_alloc()
+ * would skip them and report the pool full.
+ */
+static void ba_test_first_free_wrap(struct kunit *test)
+{
+	struct bitalloc pool;
+	int i;
+
+	KUNIT_ASSERT_EQ(test, bnxt_ba_init(&pool, BA_TEST_SIZE, true), 0);
+	for (i = 0; i < BA_TEST_SIZE; i++)
+		bnxt_ba_alloc(&pool);
+
+	KUNIT_EXPECT_EQ(test, bnxt_ba_free(&pool, 0), 0);
+	KUNIT_EXPECT_EQ(test, bnxt_ba_alloc(&pool), 0);
+	KUNIT_EXPECT_EQ(test, bnxt_ba_alloc(&pool), -1);
+
+	KUNIT_EXPECT_EQ(test, bnxt_ba_free(&pool, BA_TEST_SIZE - 1), 0);
+	KUNIT_EXPECT_EQ(test, bnxt_ba_alloc(&pool), BA_TEST_SIZE - 1);
+
+	KUNIT_EXPECT_EQ(test, bnxt_ba_free(&pool, 65), 0);
+	KUNIT_EXPECT_EQ(test, bnxt_ba_free(&pool, 10), 0);
+	KUNIT_EXPECT_EQ(test, bnxt_ba_free(&pool, 3), 0);
+	KUNIT_EXPECT_EQ(test, bnxt_ba_alloc(&pool), 3);
+	KUNIT_EXPECT_EQ(test, bnxt_ba_alloc(&pool), 10);
+	KUNIT_EXPECT_EQ(test, bnxt_ba_alloc(&pool), 65);
+	KUNIT_EXPECT_EQ(test, bnxt_ba_alloc(&pool), -1);
+	bnxt_ba_deinit(&pool);
+}
+
+/* Same for last_free and frees at or above it */
+static void ba_test_last_free_wrap(struct kunit *test)
+{
+	struct bitalloc pool;
+	int i;
+
+	KUNIT_ASSERT_EQ(test, bnxt_ba_init(&pool, BA_TEST_SIZE, true), 0);
+	for (i = BA_TEST_SIZE - 1; i >= 0; i--)
+		KUNIT_EXPECT_EQ(test, bnxt_ba_alloc_reverse(&pool), i);
+	KUNIT_EXPECT_EQ(test, bnxt_ba_alloc_reverse(&pool), -1);
+
+	KUNIT_EXPECT_EQ(test, bnxt_ba_free(&pool, BA_TEST_SIZE - 1), 0);
+	KUNIT_EXPECT_EQ(test, bnxt_ba_alloc_reverse(&pool), BA_TEST_SIZE - 1);
+
+	KUNIT_EXPECT_EQ(test, bnxt_ba_free(&pool, 0), 0);
+	KUNIT_EXPECT_EQ(test, bnxt_ba_alloc_reverse(&pool), 0);
+
+	KUNIT_EXPECT_EQ(test, bnxt_ba_free(&pool, 5), 0);
+	KUNIT_EXPECT_EQ(test, bnxt_ba_free(&pool, 64), 0);
+	KUNIT_EXPECT_EQ(test, bnxt_ba_alloc_reverse(&pool), 64);
+	KUNIT_EXPECT_EQ(test, bnxt_ba_alloc_reverse(&pool), 5);
+	KUNIT_EXPECT_EQ(test, bnxt_ba_alloc_reverse(&pool), -1);
+	bnxt_ba_deinit(&pool);
+}
+
+/* Forward and reverse allocation meet in the middle */
+static void ba_test_alloc_both_ends(struct kunit *test)
+{
+	struct bitalloc pool;
+	int i;
+
+	KUNIT_ASSERT_EQ(test, bnxt_ba_init(&pool, 8, true), 0);
+	for (i = 0; i < 4; i++) {
+		KUNIT_EXPECT_EQ(test, bnxt_ba_alloc(&pool), i);
+		KUNIT_EXPECT_EQ(test, bnxt_ba_alloc_reverse(&pool), 7 - i);
+	}
+	KUNIT_EXPECT_EQ(test, bnxt_ba_alloc(&pool), -1);
+	KUNIT_EXPECT_EQ(test, bnxt_ba_alloc_reverse(&pool), -1);
+
+	KUNIT_EXPECT_EQ(test, bnxt_ba_free(&pool, 4), 0);
+	KUNIT_EXPECT_EQ(test, bnxt_ba_alloc(&pool), 4);
+	KUNIT_EXPECT_EQ(test, bnxt_ba_free(&pool, 3), 0);
+	KUNIT_EXPECT_EQ(test, bnxt_ba_alloc_reverse(&pool), 3);
+	bnxt_ba_deinit(&pool);
+}
+
+/* A pool initialized as fully allocated only hands out freed indexes */
+static void ba_test_start_full(struct kunit *test)
+{
+	struct bitalloc pool;
+
+	KUNIT_ASSERT_EQ(test, bnxt_ba_init(&pool, BA_TEST_SIZE, false), 0);
+	KUNIT_EXPECT_EQ(test, bnxt_ba_alloc(&pool), -1);
+	KUNIT_EXPECT_EQ(test, bnxt_ba_alloc_reverse(&pool), -1);
+
+	KUNIT_EXPECT_EQ(test, bnxt_ba_free(&pool, 40), 0);
+	KUNIT_EXPECT_EQ(test, bnxt_ba_alloc(&pool), 40);
+	KUNIT_EXPECT_EQ(test, bnxt_ba_free(&pool, 41), 0);
+	KUNIT_EXPECT_EQ(test, bnxt_ba_alloc_reverse(&pool), 41);
+	KUNIT_EXPECT_EQ(test, bnxt_ba_free_count(&pool), 0);
+	bnxt_ba_deinit(&pool);
+}
+
+static void ba_test_alloc_index(struct kunit *test)
+{
+	struct bitalloc pool;
+
+	KUNIT_ASSERT_EQ(test, bnxt_ba_init(&pool, BA_TEST_SIZE, true), 0);
+	KUNIT_EXPECT_EQ(test, bnxt_ba_alloc_index(&pool, 0), 0);
+	KUNIT_EXPECT_EQ(test, bnxt_ba_alloc_index(&pool, 0), -1);
+	KUNIT_EXPECT_EQ(test, bnxt_ba_alloc_index(&pool, BA_TEST_SIZE - 1),
+			BA_TEST_SIZE - 1);
+	KUNIT_EXPECT_EQ(test, bnxt_ba_alloc_index(&pool, -1), -1);
+	KUNIT_EXPECT_EQ(test, bnxt_ba_alloc_index(&pool, BA_TEST_SIZE), -1);
+
+	/* Indexes taken explicitly are skipped by both search directions */
+	KUNIT_EXPECT_EQ(test, bnxt_ba_alloc(&pool), 1);
+	KUNIT_EXPECT_EQ(test, bnxt_ba_alloc_reverse(&pool), BA_TEST_SIZE - 2);
+	KUNIT_EXPECT_EQ(test, bnxt_ba_inuse_count(&pool), 4);
+	bnxt_ba_deinit(&pool);
+}
+
+static void ba_test_free_errors(struct kunit *test)
+{
+	struct bitalloc pool;
+
+	KUNIT_ASSERT_EQ(test, bnxt_ba_init(&pool, BA_TEST_SIZE, true), 0);
+	KUNIT_EXPECT_EQ(test, bnxt_ba_free(&pool, 0), -1);
+	KUNIT_EXPECT_EQ(test, bnxt_ba_free(&pool, -1), -1);
+	KUNIT_EXPECT_EQ(test, bnxt_ba_free(&pool, BA_TEST_SIZE), -1);
+
+	KUNIT_EXPECT_EQ(test, bnxt_ba_alloc(&pool), 0);
+	KUNIT_EXPECT_EQ(test, bnxt_ba_free(&pool, 0), 0);
+	KUNIT_EXPECT_EQ(test, bnxt_ba_free(&pool, 0), -1);
+	KUNIT_EXPECT_EQ(test, bnxt_ba_free_count(&pool), BA_TEST_SIZE);
+	bnxt_ba_deinit(&pool);
+}
+
+static void ba_test_search(struct kunit *test)
+{
+	struct bitalloc pool;
+
+	KUNIT_ASSERT_EQ(test, bnxt_ba_init(&pool, BA_TEST_SIZE, true), 0);
+	KUNIT_EXPECT_EQ(test, bnxt_ba_find_next_inuse(&pool, 0), -1);
+
+	bnxt_ba_alloc_index(&pool, 0);
+	bnxt_ba_alloc_index(&pool, 2);
+	bnxt_ba_alloc_index(&pool, 66);
+	bnxt_ba_alloc_index(&pool, BA_TEST_SIZE - 1);
+
+	KUNIT_EXPECT_EQ(test, bnxt_ba_inuse(&pool, 0), 1);
+	KUNIT_EXPECT_EQ(test, bnxt_ba_inuse(&pool, 1), 0);
+	KUNIT_EXPECT_EQ(test, bnxt_ba_inuse(&pool, BA_TEST_SIZE), -1);
+
+	/* The search starts after the given index */
+	KUNIT_EXPECT_EQ(test, bnxt_ba_find_next_inuse(&pool, 0), 2);
+	KUNIT_EXPECT_EQ(test, bnxt_ba_find_next_inuse(&pool, 2), 66);
+	KUNIT_EXPECT_EQ(test, bnxt_ba_find_next_inuse(&pool, 66),
+			BA_TEST_SIZE - 1);
+	KUNIT_EXPECT_EQ(test, bnxt_ba_find_next_inuse(&pool, BA_TEST_SIZE - 1),
+			-1);
+
+	KUNIT_EXPECT_EQ(test, bnxt_ba_find_next_inuse_free(&pool, 0), 2);
+	KUNIT_EXPECT_EQ(test, bnxt_ba_inuse(&pool, 2), 0);
+	KUNIT_EXPECT_EQ(test, bnxt_ba_find_next_inuse(&pool, 0), 66);
+
+	KUNIT_EXPECT_EQ(test, bnxt_ba_inuse_free(&pool, 66), 1);
+	KUNIT_EXPECT_EQ(test, bnxt_ba_inuse_free(&pool, 66), 0);
+	KUNIT_EXPECT_EQ(test, bnxt_ba_inuse_count(&pool), 2);
+
+	/* Indexes freed by the search helpers are handed out again */
+	KUNIT_EXPECT_EQ(test, bnxt_ba_alloc(&pool), 1);
+	KUNIT_EXPECT_EQ(test, bnxt_ba_alloc(&pool), 2);
+	KUNIT_EXPECT_EQ(test, bnxt_ba_alloc_reverse(&pool), 68);
+	bnxt_ba_deinit(&pool);
+}
+
+static struct kunit_case bnxt_ba_test_cases[] = {
+	KUNIT_CASE(ba_test_init),
+	KUNIT_CASE(ba_test_alloc_until_full),
+	KUNIT_CASE(ba_test_first_free_wrap),
+	KUNIT_CASE(ba_test_last_free_wrap),
+	KUNIT_CASE(ba_test_alloc_both_ends),
+	KUNIT_CASE(ba_test_start_full),
+	KUNIT_CASE(ba_test_alloc_index),
+	KUNIT_CASE(ba_test_free_errors),
+	KUNIT_CASE(ba_test_search),
+	{}
+};
+
+static struct kunit_suite bnxt_ba_test_suite = {
+	.name = "bnxt_bitalloc",
+	.test_cases = bnxt_ba_test_cases,
+};
+
+kunit_test_suite(bnxt_ba_test_suite);
+
+MODULE_DESCRIPTION("KUnit tests for the bnxt_en TruFlow bit allocator");
+MODULE_LICENSE("Dual BSD/GPL");
@@ -0,0 +1,135 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright(c) 2026 Broadcom
+ * All rights reserved.
+ */
+#include <kunit/test.h>
+#include <linux/module.h>
+#include <linux/bitmap.h>
+
+/* The memory manager is not exported by bnxt_en, build a private copy */
+#include "cfa_mm.c"
+
+#define MM_TEST_RECORDS	64
+#define MM_TEST_CONTIG	4
+
+static void *mm_test_open(struct kunit *test)
+{
+	struct cfa_mm_query_parms qparms = {
+		.max_records = MM_TEST_RECORDS,
+		.max_contig_records = MM_TEST_CONTIG,
+	};
+	struct cfa_mm_open_parms oparms = {
+		.max_records = MM_TEST_RECORDS,
+		.max_contig_records = MM_TEST_CONTIG,
+	};
+	void *cmm;
+
+	KUNIT_ASSERT_EQ(test, cfa_mm_query(&qparms), 0);
+	cmm = kunit_kzalloc(test, qparms.db_size, GFP_KERNEL);
+	KUNIT_ASSERT_NOT_NULL(test, cmm);
+
+	oparms.db_mem_size = qparms.db_size - 1;
+	KUNIT_EXPECT_EQ(test, cfa_mm_open(cmm, &oparms), -EINVAL);
+	oparms.db_mem_size = qparms.db_size;
+	KUNIT_ASSERT_EQ(test, cfa_mm_open(cmm, &oparms), 0);
+	return cmm;
+}
+
+static void mm_test_query(struct kunit *test)
+{
+	struct cfa_mm_query_parms parms = {
+		.max_records = MM_TEST_RECORDS,
+		.max_contig_records = 3,
+	};
+
+	KUNIT_EXPECT_EQ(test, cfa_mm_query(&parms), -EINVAL);
+	parms.max_contig_records = CFA_MM_MAX_CONTIG_RECORDS * 2;
+	KUNIT_EXPECT_EQ(test, cfa_mm_query(&parms), -EINVAL);
+	parms.max_contig_records = MM_TEST_CONTIG;
+	parms.max_records = 0;
+	KUNIT_EXPECT_EQ(test, cfa_mm_query(&parms), -EINVAL);
+}
+
+static void mm_test_alloc_until_full(struct kunit *test)
+{
+	struct cfa_mm_alloc_parms aparms = {
+		.num_contig_records = MM_TEST_CONTIG,
+	};
+	DECLARE_BITMAP(used, MM_TEST_RECORDS);
+	void *cmm = mm_test_open(test);
+	int i;
+
+	bitmap_zero(used, MM_TEST_RECORDS);
+	for (i = 0; i < MM_TEST_RECORDS / MM_TEST_CONTIG; i++) {
+		KUNIT_ASSERT_EQ(test, cfa_mm_alloc(cmm, &aparms), 0);
+		KUNIT_ASSERT_LT(test, aparms.record_offset, MM_TEST_RECORDS);
+		KUNIT_EXPECT_EQ(test, aparms.record_offset % MM_TEST_CONTIG, 0);
+		KUNIT_EXPECT_FALSE(test, test_and_set_bit(aparms.record_offset,
+							  used));
+		KUNIT_EXPECT_EQ(test, aparms.used_count,
+				(i + 1) * MM_TEST_CONTIG);
+	}
+	KUNIT_EXPECT_TRUE(test, aparms.all_used);
+	KUNIT_EXPECT_EQ(test, cfa_mm_alloc(cmm, &aparms), -ENOMEM);
+
+	KUNIT_EXPECT_EQ(test, cfa_mm_close(cmm), 0);
+	KUNIT_EXPECT_EQ(test, cfa_mm_alloc(cmm, &aparms), -EINVAL);
+}
+
+static void mm_test_free(struct kunit *test)
+{
+	struct cfa_mm_alloc_parms aparms = {
+		.num_contig_records = MM_TEST_CONTIG,
+	};
+	struct cfa_mm_free_parms fparms = {
+		.num_contig_records = MM_TEST_CONTIG,
+	};
+	void *cmm = mm_test_open(test);
+	u32 first, second;
+	u8 size;
+
+	aparms.num_contig_records = 3;
+	KUNIT_EXPECT_EQ(test, cfa_mm_alloc(cmm, &aparms), -EINVAL);
+	aparms.num_contig_records = MM_TEST_CONTIG * 2;
+	KUNIT_EXPECT_EQ(test, cfa_mm_alloc(cmm, &aparms), -EINVAL);
+
+	aparms.num_contig_records = MM_TEST_CONTIG;
+	KUNIT_ASSERT_EQ(test, cfa_mm_alloc(cmm, &aparms), 0);
+	first = aparms.record_offset;
+	KUNIT_ASSERT_EQ(test, cfa_mm_alloc(cmm, &aparms), 0);
+	second = aparms.record_offset;
+	KUNIT_EXPECT_NE(test, first, second);
+
+	KUNIT_EXPECT_EQ(test, cfa_mm_entry_size_get(cmm, first, &size), 0);
+	KUNIT_EXPECT_EQ(test, size, MM_TEST_CONTIG);
+
+	fparms.record_offset = first;
+	KUNIT_EXPECT_EQ(test, cfa_mm_free(cmm, &fparms), 0);
+	KUNIT_EXPECT_EQ(test, fparms.used_count, MM_TEST_CONTIG);
+	KUNIT_EXPECT_EQ(test, cfa_mm_free(cmm, &fparms), -EINVAL);
+	KUNIT_EXPECT_EQ(test, cfa_mm_entry_size_get(cmm, first, &size),
+			-ENOENT);
+	KUNIT_EXPECT_EQ(test, cfa_mm_entry_size_get(cmm, second, &size), 0);
+
+	/* The freed records are handed out again */
+	KUNIT_ASSERT_EQ(test, cfa_mm_alloc(cmm, &aparms), 0);
+	KUNIT_EXPECT_EQ(test, aparms.record_offset, first);
+	KUNIT_EXPECT_EQ(test, cfa_mm_close(cmm), 0);
+}
+
+static struct kunit_case bnxt_cfa_mm_test_cases[] = {
+	KUNIT_CASE(mm_test_query),
+	KUNIT_CASE(mm_test_alloc_until_full),
+	KUNIT_CASE(mm_test_free),
+	{}
+};
+
+static struct kunit_suite bnxt_cfa_mm_test_suite = {
+	.name = "bnxt_cfa_mm",
+	.test_cases = bnxt_cfa_mm_test_cases,
+};
+
+kunit_test_suite(bnxt_cfa_mm_test_suite);
+
+MODULE_DESCRIPTION("KUnit tests for the bnxt_en CFA memory manager");
+MODULE_LICENSE("Dual BSD/GPL");
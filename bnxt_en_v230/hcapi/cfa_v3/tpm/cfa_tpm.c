@@ -78,6 +78,7 @@ int cfa_tpm_close(void *tpm)
 		return -EINVAL;
 	}
 
+	bnxt_ba_deinit(ctx->pool_ba);
 	memset(tpm, 0, cfa_tpm_size(ctx->max_pools));
 
 	return 0;
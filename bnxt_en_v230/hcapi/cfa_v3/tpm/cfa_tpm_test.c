@@ -0,0 +1,101 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright(c) 2026 Broadcom
+ * All rights reserved.
+ */
+#include <kunit/test.h>
+#include <linux/module.h>
+
+/* Neither the pool manager nor the allocator under it is exported by
+ * bnxt_en, build private copies.
+ */
+#include "bitalloc.c"
+#include "cfa_tpm.c"
+
+#define TPM_TEST_POOLS	8
+#define TPM_TEST_FID	0x10
+
+static void *tpm_test_open(struct kunit *test)
+{
+	u32 db_size;
+	void *tpm;
+
+	KUNIT_EXPECT_EQ(test, cfa_tpm_query(0, &db_size), -EINVAL);
+	KUNIT_EXPECT_EQ(test, cfa_tpm_query(CFA_TPM_MAX_POOLS + 1, &db_size),
+			-EINVAL);
+	KUNIT_ASSERT_EQ(test, cfa_tpm_query(TPM_TEST_POOLS, &db_size), 0);
+	tpm = kunit_kzalloc(test, db_size, GFP_KERNEL);
+	KUNIT_ASSERT_NOT_NULL(test, tpm);
+
+	KUNIT_EXPECT_EQ(test, cfa_tpm_open(tpm, db_size - 1, TPM_TEST_POOLS),
+			-EINVAL);
+	KUNIT_ASSERT_EQ(test, cfa_tpm_open(tpm, db_size, TPM_TEST_POOLS), 0);
+	return tpm;
+}
+
+static void tpm_test_alloc_until_full(struct kunit *test)
+{
+	void *tpm = tpm_test_open(test);
+	u16 pool_id;
+	int i;
+
+	for (i = 0; i < TPM_TEST_POOLS; i++) {
+		KUNIT_ASSERT_EQ(test, cfa_tpm_alloc(tpm, &pool_id), 0);
+		KUNIT_EXPECT_EQ(test, pool_id, i);
+	}
+	KUNIT_EXPECT_EQ(test, cfa_tpm_alloc(tpm, &pool_id), -ENOMEM);
+
+	KUNIT_EXPECT_EQ(test, cfa_tpm_free(tpm, 3), 0);
+	KUNIT_EXPECT_EQ(test, cfa_tpm_free(tpm, 3), -1);
+	KUNIT_ASSERT_EQ(test, cfa_tpm_alloc(tpm, &pool_id), 0);
+	KUNIT_EXPECT_EQ(test, pool_id, 3);
+
+	KUNIT_EXPECT_EQ(test, cfa_tpm_close(tpm), 0);
+	KUNIT_EXPECT_EQ(test, cfa_tpm_alloc(tpm, &pool_id), -EINVAL);
+}
+
+static void tpm_test_fid(struct kunit *test)
+{
+	void *tpm = tpm_test_open(test);
+	u16 pool_id, fid;
+
+	KUNIT_EXPECT_EQ(test, cfa_tpm_fid_add(tpm, 0, TPM_TEST_FID), -EINVAL);
+	KUNIT_ASSERT_EQ(test, cfa_tpm_alloc(tpm, &pool_id), 0);
+	KUNIT_EXPECT_EQ(test, cfa_tpm_srch_by_pool(tpm, pool_id, &fid),
+			-EINVAL);
+
+	KUNIT_EXPECT_EQ(test, cfa_tpm_fid_add(tpm, pool_id, TPM_TEST_FID), 0);
+	KUNIT_EXPECT_EQ(test, cfa_tpm_fid_add(tpm, pool_id, TPM_TEST_FID + 1),
+			-EINVAL);
+	KUNIT_EXPECT_EQ(test, cfa_tpm_srch_by_pool(tpm, pool_id, &fid), 0);
+	KUNIT_EXPECT_EQ(test, fid, TPM_TEST_FID);
+
+	KUNIT_EXPECT_EQ(test, cfa_tpm_srchm_by_fid(tpm, CFA_SRCH_MODE_FIRST,
+						   TPM_TEST_FID, &fid), 0);
+	KUNIT_EXPECT_EQ(test, fid, pool_id);
+	KUNIT_EXPECT_EQ(test, cfa_tpm_srchm_by_fid(tpm, CFA_SRCH_MODE_NEXT,
+						   TPM_TEST_FID, &fid), -ENOENT);
+
+	/* A pool can not go away while a function still uses it */
+	KUNIT_EXPECT_EQ(test, cfa_tpm_free(tpm, pool_id), -EINVAL);
+	KUNIT_EXPECT_EQ(test, cfa_tpm_fid_rem(tpm, pool_id, TPM_TEST_FID + 1),
+			-EINVAL);
+	KUNIT_EXPECT_EQ(test, cfa_tpm_fid_rem(tpm, pool_id, TPM_TEST_FID), 0);
+	KUNIT_EXPECT_EQ(test, cfa_tpm_free(tpm, pool_id), 0);
+	KUNIT_EXPECT_EQ(test, cfa_tpm_close(tpm), 0);
+}
+
+static struct kunit_case bnxt_cfa_tpm_test_cases[] = {
+	KUNIT_CASE(tpm_test_alloc_until_full),
+	KUNIT_CASE(tpm_test_fid),
+	{}
+};
+
+static struct kunit_suite bnxt_cfa_tpm_test_suite = {
+	.name = "bnxt_cfa_tpm",
+	.test_cases = bnxt_cfa_tpm_test_cases,
+};
+
+kunit_test_suite(bnxt_cfa_tpm_test_suite);
+
+MODULE_DESCRIPTION("KUnit tests for the bnxt_en CFA table pool manager");
+MODULE_LICENSE("Dual BSD/GPL");
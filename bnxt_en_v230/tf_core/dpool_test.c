@@ -0,0 +1,98 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright(c) 2026 Broadcom
+ * All rights reserved.
+ */
+#include <kunit/test.h>
+#include <linux/module.h>
+
+/* The allocator is not exported by bnxt_en, build a private copy */
+#include "dpool.c"
+
+#define DP_TEST_START	100
+#define DP_TEST_SIZE	16
+#define DP_TEST_MAX	4
+
+static void dp_test_alloc_errors(struct kunit *test)
+{
+	struct dpool pool;
+
+	KUNIT_ASSERT_EQ(test, dpool_init(&pool, DP_TEST_START, DP_TEST_SIZE,
+					 DP_TEST_MAX, NULL, NULL), 0);
+	KUNIT_EXPECT_EQ(test, dpool_alloc(&pool, 0, DP_DEFRAG_NONE),
+			DP_INVALID_INDEX);
+	KUNIT_EXPECT_EQ(test, dpool_alloc(&pool, DP_TEST_MAX + 1,
+					  DP_DEFRAG_NONE), DP_INVALID_INDEX);
+
+	/* Defrag needs the EM move callback */
+	KUNIT_EXPECT_EQ(test, dpool_alloc(&pool, 1, DP_DEFRAG_ALL),
+			DP_INVALID_INDEX);
+	vfree(pool.entry);
+}
+
+static void dp_test_alloc_until_full(struct kunit *test)
+{
+	struct dpool pool;
+	u32 i;
+
+	KUNIT_ASSERT_EQ(test, dpool_init(&pool, DP_TEST_START, DP_TEST_SIZE,
+					 DP_TEST_MAX, NULL, NULL), 0);
+	for (i = 0; i < DP_TEST_SIZE; i += DP_TEST_MAX)
+		KUNIT_EXPECT_EQ(test, dpool_alloc(&pool, DP_TEST_MAX,
+						  DP_DEFRAG_NONE),
+				DP_TEST_START + i);
+	KUNIT_EXPECT_EQ(test, dpool_alloc(&pool, 1, DP_DEFRAG_NONE),
+			DP_INVALID_INDEX);
+
+	/* The freed block is the only space left */
+	KUNIT_EXPECT_EQ(test, dpool_free(&pool, DP_TEST_START + 4), 0);
+	KUNIT_EXPECT_EQ(test, dpool_alloc(&pool, 2, DP_DEFRAG_NONE),
+			DP_TEST_START + 4);
+	KUNIT_EXPECT_EQ(test, dpool_alloc(&pool, 2, DP_DEFRAG_NONE),
+			DP_TEST_START + 6);
+	KUNIT_EXPECT_EQ(test, dpool_alloc(&pool, 1, DP_DEFRAG_NONE),
+			DP_INVALID_INDEX);
+
+	dpool_free_all(&pool);
+	KUNIT_EXPECT_EQ(test, dpool_alloc(&pool, DP_TEST_MAX, DP_DEFRAG_NONE),
+			DP_TEST_START);
+	vfree(pool.entry);
+}
+
+static void dp_test_free_errors(struct kunit *test)
+{
+	struct dpool pool;
+
+	KUNIT_ASSERT_EQ(test, dpool_init(&pool, DP_TEST_START, DP_TEST_SIZE,
+					 DP_TEST_MAX, NULL, NULL), 0);
+	KUNIT_EXPECT_EQ(test, dpool_alloc(&pool, 3, DP_DEFRAG_NONE),
+			DP_TEST_START);
+
+	/* Only the first index of an entry may be freed or tagged */
+	KUNIT_EXPECT_EQ(test, dpool_free(&pool, DP_TEST_START + 1), -1);
+	KUNIT_EXPECT_EQ(test, dpool_set_entry_data(&pool, DP_TEST_START + 1,
+						   1), -1);
+	KUNIT_EXPECT_EQ(test, dpool_set_entry_data(&pool, DP_TEST_START, 1),
+			0);
+
+	KUNIT_EXPECT_EQ(test, dpool_free(&pool, DP_TEST_START - 1), -1);
+	KUNIT_EXPECT_EQ(test, dpool_free(&pool, DP_TEST_START), 0);
+	KUNIT_EXPECT_EQ(test, dpool_free(&pool, DP_TEST_START), -1);
+	vfree(pool.entry);
+}
+
+static struct kunit_case bnxt_dpool_test_cases[] = {
+	KUNIT_CASE(dp_test_alloc_errors),
+	KUNIT_CASE(dp_test_alloc_until_full),
+	KUNIT_CASE(dp_test_free_errors),
+	{}
+};
+
+static struct kunit_suite bnxt_dpool_test_suite = {
+	.name = "bnxt_dpool",
+	.test_cases = bnxt_dpool_test_cases,
+};
+
+kunit_test_suite(bnxt_dpool_test_suite);
+
+MODULE_DESCRIPTION("KUnit tests for the bnxt_en TruFlow dynamic pool allocator");
+MODULE_LICENSE("Dual BSD/GPL");
@@ -1109,10 +1109,48 @@ cleanup:
 int tf_msg_bulk_get_tbl_entry(struct tf *tfp, enum tf_dir dir,
 			      u16 hcapi_type, u32 starting_idx,
 			      u16 num_entries, u16 entry_sz_in_bytes,
-			      u64 physical_mem_addr, bool clear_on_read)
+			      u64 physical_mem_addr, bool clear_on_read,
+			      u8 fw_session_id)
 {
-	/* TBD */
-	return -EINVAL;
+	struct hwrm_tf_tbl_type_bulk_get_output *resp = NULL;
+	struct hwrm_tf_tbl_type_bulk_get_input *req = NULL;
+	struct bnxt *bp = tfp->bp;
+	u32 data_size;
+	u32 flags = 0;
+	int rc;
+
+	flags = (dir == TF_DIR_TX ?
+		 TF_TBL_TYPE_BULK_GET_REQ_FLAGS_DIR_TX :
+		 TF_TBL_TYPE_BULK_GET_REQ_FLAGS_DIR_RX);
+
+	if (clear_on_read)
+		flags |= TF_TBL_TYPE_BULK_GET_REQ_FLAGS_CLEAR_ON_READ;
+
+	rc = hwrm_req_init(bp, req, HWRM_TF_TBL_TYPE_BULK_GET);
+	if (rc)
+		return rc;
+	resp = hwrm_req_hold(bp, req);
+
+	/* Populate the request */
+	req->fw_session_id = cpu_to_le32(fw_session_id);
+	req->flags = cpu_to_le16(flags);
+	req->type = cpu_to_le32(hcapi_type);
+	req->start_index = cpu_to_le32(starting_idx);
+	req->num_entries = cpu_to_le32(num_entries);
+	req->host_addr = cpu_to_le64(physical_mem_addr);
+
+	rc = hwrm_req_send(bp, req);
+	if (rc)
+		goto cleanup;
+
+	/* Verify that the firmware returned all of the requested data */
+	data_size = num_entries * entry_sz_in_bytes;
+	if (le16_to_cpu(resp->size) < data_size)
+		rc = -EINVAL;
+
+cleanup:
+	hwrm_req_drop(bp, req);
+	return rc;
 }
 
 int tf_msg_get_if_tbl_entry(struct tf *tfp,
@@ -330,9 +330,18 @@ int tf_msg_set_global_cfg(struct tf *tfp, struct tf_global_cfg_parms *params,
 
 /**
  * Sends bulk get message of a Table Type element to the firmware.
- *
- * @tfp:	Pointer to session handle
- * @parms:	Pointer to table get bulk parameters
+ * The firmware DMAs num_entries consecutive entries, starting at
+ * starting_idx, to the host buffer at physical_mem_addr.
+ *
+ * @tfp:		Pointer to session handle
+ * @dir:		Direction
+ * @hcapi_type:		Type of the object
+ * @starting_idx:	First entry to read
+ * @num_entries:	Number of consecutive entries to read
+ * @entry_sz_in_bytes:	Size of a single entry
+ * @physical_mem_addr:	DMA address of the host buffer
+ * @clear_on_read:	Clear the entries after they are read
+ * @fw_session_id:	fw session id
  *
  * Returns:
  *  0 on Success else internal Truflow error
@@ -340,7 +349,7 @@ int tf_msg_set_global_cfg(struct tf *tfp, struct tf_global_cfg_parms *params,
 int tf_msg_bulk_get_tbl_entry(struct tf *tfp, enum tf_dir dir, u16 hcapi_type,
 			      u32 starting_idx, u16 num_entries,
 			      u16 entry_sz_in_bytes, u64 physical_mem_addr,
-			      bool clear_on_read);
+			      bool clear_on_read, u8 fw_session_id);
 
 /**
  * Sends Set message of a IF Table Type element to the firmware.
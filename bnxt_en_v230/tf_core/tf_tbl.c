@@ -458,6 +458,7 @@ int tf_tbl_bulk_get(struct tf *tfp, struct tf_tbl_get_bulk_parms *parms)
 	struct tf_dev_info *dev;
 	void *tbl_db_ptr = NULL;
 	struct tf_session *tfs;
+	u8 fw_session_id;
 	u16 hcapi_type;
 	int rc;
 
@@ -476,6 +477,10 @@ int tf_tbl_bulk_get(struct tf *tfp, struct tf_tbl_get_bulk_parms *parms)
 	if (rc)
 		return rc;
 
+	rc = tf_session_get_fw_session_id(tfp, &fw_session_id);
+	if (rc)
+		return rc;
+
 	rc = tf_session_get_db(tfp, TF_MODULE_TYPE_TABLE, &tbl_db_ptr);
 	if (rc) {
 		netdev_dbg(bp->dev,
@@ -516,7 +521,8 @@ int tf_tbl_bulk_get(struct tf *tfp, struct tf_tbl_get_bulk_parms *parms)
 				       parms->starting_idx,
 				       parms->num_entries,
 				       parms->entry_sz_in_bytes,
-				       parms->physical_mem_addr, false);
+				       parms->physical_mem_addr, false,
+				       fw_session_id);
 	if (rc) {
 		netdev_dbg(bp->dev, "%s, Bulk get failed, type:%s, rc:%d\n",
 			   tf_dir_2_str(parms->dir),
@@ -553,6 +553,7 @@ int tf_tbl_sram_bulk_get(struct tf *tfp, struct tf_tbl_get_bulk_parms *parms)
 	struct tf_dev_info *dev;
 	struct tf_session *tfs;
 	bool allocated = false;
+	u8 fw_session_id;
 	u16 hcapi_type;
 	u16 idx;
 	int rc;
@@ -565,6 +566,10 @@ int tf_tbl_sram_bulk_get(struct tf *tfp, struct tf_tbl_get_bulk_parms *parms)
 	if (rc)
 		return rc;
 
+	rc = tf_session_get_fw_session_id(tfp, &fw_session_id);
+	if (rc)
+		return rc;
+
 	rc = tf_session_get_db(tfp, TF_MODULE_TYPE_TABLE, &tbl_db_ptr);
 	if (rc) {
 		netdev_dbg(tfp->bp->dev,
@@ -648,7 +653,8 @@ int tf_tbl_sram_bulk_get(struct tf *tfp, struct tf_tbl_get_bulk_parms *parms)
 				       parms->num_entries,
 				       parms->entry_sz_in_bytes,
 				       parms->physical_mem_addr,
-				       clear_on_read);
+				       clear_on_read,
+				       fw_session_id);
 	if (rc) {
 		netdev_dbg(tfp->bp->dev,
 			   "%s, Bulk get failed, type:%s, rc:%d\n",
@@ -397,11 +397,7 @@ int bnxt_ulp_flow_create(struct bnxt *bp, u16 src_fid,
 	/* Dump the tc flow action */
 	ulp_parser_act_info_dump(params);
 
-	ret = ulp_matcher_pattern_match(params, &params->class_id);
-	if (ret != BNXT_TF_RC_SUCCESS)
-		goto free_fid;
-
-	ret = ulp_matcher_action_match(params, &params->act_tmpl);
+	ret = ulp_matcher_flow_match(params);
 	if (ret != BNXT_TF_RC_SUCCESS)
 		goto free_fid;
 
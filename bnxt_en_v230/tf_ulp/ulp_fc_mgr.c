@@ -46,22 +46,44 @@ static int
 ulp_fc_mgr_shadow_mem_alloc(struct bnxt_ulp_context *ulp_ctx,
 			    struct hw_fc_mem_info *parms, int size)
 {
-	/* Allocate memory*/
+	/* Allocate memory, the firmware DMAs bulk counter reads into it */
 	if (!parms)
 		return -EINVAL;
 
-	parms->mem_va = kzalloc(L1_CACHE_ALIGN(size), GFP_KERNEL);
+	parms->mem_size = L1_CACHE_ALIGN(size);
+	parms->mem_va = dma_alloc_coherent(&ulp_ctx->bp->pdev->dev,
+					   parms->mem_size, &parms->mem_pa,
+					   GFP_KERNEL);
 	if (!parms->mem_va)
 		return -ENOMEM;
 
-	parms->mem_pa = (void *)__pa(parms->mem_va);
 	return 0;
 }
 
 static void
-ulp_fc_mgr_shadow_mem_free(struct hw_fc_mem_info *parms)
+ulp_fc_mgr_shadow_mem_free(struct bnxt_ulp_context *ulp_ctx,
+			   struct hw_fc_mem_info *parms)
 {
-	kfree(parms->mem_va);
+	if (!parms->mem_va)
+		return;
+
+	dma_free_coherent(&ulp_ctx->bp->pdev->dev, parms->mem_size,
+			  parms->mem_va, parms->mem_pa);
+	parms->mem_va = NULL;
+}
+
+/* Delay until the next flow counter harvest, from the
+ * "truflow_fc_poll_interval" devlink parameter.
+ */
+static unsigned long
+ulp_fc_mgr_poll_delay(struct bnxt_ulp_context *ctxt)
+{
+	u32 interval = BNXT_TF_FC_POLL_INTERVAL_DEF;
+
+	if (ctxt && ctxt->bp && READ_ONCE(ctxt->bp->tf_fc_poll_interval))
+		interval = READ_ONCE(ctxt->bp->tf_fc_poll_interval);
+
+	return msecs_to_jiffies(interval);
 }
 
 /**
@@ -99,7 +121,7 @@ ulp_fc_mgr_init(struct bnxt_ulp_context *ctxt)
 
 	/* update the features list */
 	if (dparms->dev_features & BNXT_ULP_DEV_FT_STAT_SW_AGG)
-		flags = ULP_FLAG_FC_SW_AGG_EN;
+		flags = ULP_FLAG_FC_SW_AGG_EN | ULP_FLAG_FC_BULK_EN;
 	if (dparms->dev_features & BNXT_ULP_DEV_FT_STAT_PARENT_AGG)
 		flags |= ULP_FLAG_FC_PARENT_AGG_EN;
 
@@ -191,7 +213,7 @@ ulp_fc_mgr_deinit(struct bnxt_ulp_context *ctxt)
 
 		for (i = 0; i < TF_DIR_MAX; i++) {
 			shd_info = &ulp_fc_info->shadow_hw_tbl[i];
-			ulp_fc_mgr_shadow_mem_free(shd_info);
+			ulp_fc_mgr_shadow_mem_free(ctxt, shd_info);
 		}
 	}
 
@@ -237,7 +259,7 @@ ulp_fc_mgr_thread_start(struct bnxt_ulp_context *ctxt)
 	ulp_fc_info = bnxt_ulp_cntxt_ptr2_fc_info_get(ctxt);
 
 	INIT_DELAYED_WORK(work, ulp_fc_mgr_alarm_cb);
-	schedule_delayed_work(work, msecs_to_jiffies(1000));
+	schedule_delayed_work(work, ulp_fc_mgr_poll_delay(ctxt));
 	if (ulp_fc_info)
 		ulp_fc_info->flags |= ULP_FLAG_FC_THREAD;
 }
@@ -258,6 +280,42 @@ void ulp_fc_mgr_thread_cancel(struct bnxt_ulp_context *ctxt)
 		ulp_fc_info->flags &= ~ULP_FLAG_FC_THREAD;
 }
 
+/* Fetch the counters one firmware request at a time, used when the device
+ * has no bulk accumulation op.
+ */
+static int
+ulp_fc_mgr_single_stats_update(struct bnxt_ulp_context *ctxt,
+			       struct bnxt_ulp_fc_info *ulp_fc_info,
+			       struct bnxt_ulp_device_params *dparms)
+{
+	u32 hw_cntr_id = 0, num_entries = 0;
+	enum tf_dir dir;
+	unsigned int j;
+	int rc = 0;
+	void *tfp;
+
+	num_entries = dparms->flow_count_db_entries / 2;
+	for (dir = 0; dir < TF_DIR_MAX; dir++) {
+		for (j = 0; j < num_entries; j++) {
+			if (!ulp_fc_info->sw_acc_tbl[dir][j].valid)
+				continue;
+			hw_cntr_id = ulp_fc_info->sw_acc_tbl[dir][j].hw_cntr_id;
+			tfp = ctxt->ops->ulp_tfp_get(ctxt,
+						     ulp_fc_info->sw_acc_tbl[dir][j].session_type);
+			if (!tfp) {
+				netdev_dbg(ctxt->bp->dev,
+					   "Failed to get the truflow pointer\n");
+				return -EINVAL;
+			}
+			rc = ulp_get_single_flow_stat(ctxt, tfp, ulp_fc_info, dir,
+						      hw_cntr_id, dparms);
+			if (rc)
+				break;
+		}
+	}
+	return rc;
+}
+
 /**
  * Alarm handler that will issue the TF-Core API to fetch
  * data from the chip's internal flow counters
@@ -269,17 +327,14 @@ void ulp_fc_mgr_thread_cancel(struct bnxt_ulp_context *ctxt)
 void
 ulp_fc_mgr_alarm_cb(struct work_struct *work)
 {
-	u32 dev_id, hw_cntr_id = 0, num_entries = 0;
+	const struct bnxt_ulp_fc_core_ops *fc_ops;
 	struct bnxt_ulp_device_params *dparms;
 	struct bnxt_ulp_fc_info *ulp_fc_info;
+	struct bnxt_ulp_context *ctxt = NULL;
 	struct delayed_work *fc_work = NULL;
 	struct bnxt_ulp_data *cfg_data;
-	struct bnxt_ulp_context *ctxt;
-	struct bnxt *bp;
-	enum tf_dir dir;
-	unsigned int j;
-	int rc = 0;
-	void *tfp;
+	unsigned long delay;
+	u32 dev_id;
 
 	cfg_data = container_of(work, struct bnxt_ulp_data, fc_work.work);
 	fc_work = &cfg_data->fc_work;
@@ -291,8 +346,6 @@ ulp_fc_mgr_alarm_cb(struct work_struct *work)
 	if (!ctxt->cfg_data)
 		goto err;
 
-	bp = ctxt->bp;
-
 	ulp_fc_info = bnxt_ulp_cntxt_ptr2_fc_info_get(ctxt);
 	if (!ulp_fc_info)
 		goto err;
@@ -318,33 +371,19 @@ ulp_fc_mgr_alarm_cb(struct work_struct *work)
 		goto err;
 	}
 
-	num_entries = dparms->flow_count_db_entries / 2;
-	for (dir = 0; dir < TF_DIR_MAX; dir++) {
-		for (j = 0; j < num_entries; j++) {
-			if (!ulp_fc_info->sw_acc_tbl[dir][j].valid)
-				continue;
-			hw_cntr_id = ulp_fc_info->sw_acc_tbl[dir][j].hw_cntr_id;
-			tfp = ctxt->ops->ulp_tfp_get(ctxt,
-						     ulp_fc_info->sw_acc_tbl[dir][j].session_type);
-			if (!tfp) {
-				mutex_unlock(&ulp_fc_info->fc_lock);
-				netdev_dbg(bp->dev,
-					   "Failed to get the truflow pointer\n");
-				goto err;
-			}
-			rc = ulp_get_single_flow_stat(ctxt, tfp, ulp_fc_info, dir,
-						      hw_cntr_id, dparms);
-			if (rc)
-				break;
-		}
-	}
+	fc_ops = ulp_fc_info->fc_ops;
+	if (fc_ops->ulp_flow_stats_accum_update)
+		fc_ops->ulp_flow_stats_accum_update(ctxt, ulp_fc_info, dparms);
+	else
+		ulp_fc_mgr_single_stats_update(ctxt, ulp_fc_info, dparms);
 
 	mutex_unlock(&ulp_fc_info->fc_lock);
 
 err:
+	delay = ulp_fc_mgr_poll_delay(ctxt);
 	bnxt_ulp_cntxt_lock_release();
 	if (fc_work)
-		schedule_delayed_work(fc_work, msecs_to_jiffies(1000));
+		schedule_delayed_work(fc_work, delay);
 }
 
 /**
@@ -466,8 +505,8 @@ int ulp_fc_mgr_cntr_reset(struct bnxt_ulp_context *ctxt, enum tf_dir dir,
 	ulp_fc_info->sw_acc_tbl[dir][sw_cntr_idx].valid = false;
 	ulp_fc_info->sw_acc_tbl[dir][sw_cntr_idx].hw_cntr_id = 0;
 	ulp_fc_info->sw_acc_tbl[dir][sw_cntr_idx].session_type = 0;
-	ulp_fc_info->sw_acc_tbl[dir][sw_cntr_idx].pkt_count = 0;
-	ulp_fc_info->sw_acc_tbl[dir][sw_cntr_idx].byte_count = 0;
+	atomic64_set(&ulp_fc_info->sw_acc_tbl[dir][sw_cntr_idx].pkt_count, 0);
+	atomic64_set(&ulp_fc_info->sw_acc_tbl[dir][sw_cntr_idx].byte_count, 0);
 	ulp_fc_info->sw_acc_tbl[dir][sw_cntr_idx].pc_flow_idx = 0;
 	ulp_fc_info->sw_acc_tbl[dir][sw_cntr_idx].pkt_count_last_polled = 0;
 	ulp_fc_info->sw_acc_tbl[dir][sw_cntr_idx].byte_count_last_polled = 0;
@@ -561,21 +600,19 @@ int ulp_tf_fc_mgr_query_count_get(struct bnxt_ulp_context *ctxt,
 			goto exit;
 		}
 
-		/* TODO:
-		 * Think about optimizing with try_lock later
+		/* No fc_lock here, the counter cannot be released while
+		 * flow_db_lock is held and the accumulated values are
+		 * harvested with atomic exchanges, so a TC stats dump
+		 * never waits for the flow counter thread.
 		 */
-		mutex_lock(&ulp_fc_info->fc_lock);
 		sw_cntr_idx = hw_cntr_id -
 			ulp_fc_info->shadow_hw_tbl[dir].start_idx;
 		sw_acc_tbl_entry = &ulp_fc_info->sw_acc_tbl[dir][sw_cntr_idx];
-		if (sw_acc_tbl_entry->pkt_count) {
-			*packets = sw_acc_tbl_entry->pkt_count;
-			*bytes = sw_acc_tbl_entry->byte_count;
-			sw_acc_tbl_entry->pkt_count = 0;
-			sw_acc_tbl_entry->byte_count = 0;
+		if (atomic64_read(&sw_acc_tbl_entry->pkt_count)) {
+			*packets = atomic64_xchg(&sw_acc_tbl_entry->pkt_count, 0);
+			*bytes = atomic64_xchg(&sw_acc_tbl_entry->byte_count, 0);
 			*lastused = jiffies;
 		}
-		mutex_unlock(&ulp_fc_info->fc_lock);
 	} else if (params.resource_func == BNXT_ULP_RESOURCE_FUNC_CMM_STAT) {
 		rc = fc_ops->ulp_flow_stat_get(ctxt, &params, packets, bytes);
 	} else {
@@ -14,6 +14,7 @@
 #define ULP_FLAG_FC_THREAD			BIT(0)
 #define ULP_FLAG_FC_SW_AGG_EN			BIT(1)
 #define ULP_FLAG_FC_PARENT_AGG_EN		BIT(2)
+#define ULP_FLAG_FC_BULK_EN			BIT(3)
 #define ULP_FC_TIMER	100/* Timer freq in Sec Flow Counters */
 
 /* Macros to extract packet/byte counters from a 64-bit flow counter. */
@@ -41,10 +42,13 @@ struct bnxt_ulp_fc_core_ops {
 				       struct bnxt_ulp_device_params *dparms);
 };
 
+/* pkt_count and byte_count are accumulated by the flow counter thread and
+ * read-and-cleared by the stats query path without taking fc_lock.
+ */
 struct sw_acc_counter {
-	u64 pkt_count;
+	atomic64_t pkt_count;
 	u64 pkt_count_last_polled;
-	u64 byte_count;
+	atomic64_t byte_count;
 	u64 byte_count_last_polled;
 	bool	valid;
 	u32 hw_cntr_id;
@@ -54,7 +58,8 @@ struct sw_acc_counter {
 
 struct hw_fc_mem_info {
 	void *mem_va; /* mem_va, pointer to the allocated memory. */
-	void *mem_pa; /* mem_pa, physical address of the allocated memory. */
+	dma_addr_t mem_pa; /* mem_pa, DMA address of the allocated memory. */
+	u32 mem_size;
 	u32 start_idx;
 	bool start_idx_is_set;
 };
@@ -16,6 +16,9 @@
 #include "tf_tbl.h"
 
 #ifdef CONFIG_BNXT_FLOWER_OFFLOAD
+/* Max counters fetched by a single bulk get request */
+#define ULP_FC_TF_BULK_MAX_ENTRIES	1024
+
 int
 ulp_tf_fc_tf_flow_stat_get(struct bnxt_ulp_context *ctxt,
 			   struct ulp_flow_db_res_params *res,
@@ -65,6 +68,32 @@ ulp_tf_fc_tf_flow_stat_get(struct bnxt_ulp_context *ctxt,
 	return rc;
 }
 
+/* Fold a raw HW counter value into the SW accumulator entry.  A read that
+ * clears the HW counter restarts the next delta from zero.
+ */
+static void
+ulp_fc_tf_accum_entry(struct sw_acc_counter *sw_acc_tbl_entry, u64 stats,
+		      bool clear_on_read, struct bnxt_ulp_device_params *dparms)
+{
+	u64 delta_pkts, delta_bytes;
+	u64 cur_pkts, cur_bytes;
+
+	cur_pkts = FLOW_CNTR_PKTS(stats, dparms);
+	cur_bytes = FLOW_CNTR_BYTES(stats, dparms);
+
+	delta_pkts = ((cur_pkts - sw_acc_tbl_entry->pkt_count_last_polled) &
+		      FLOW_CNTR_PKTS_MAX(dparms));
+	delta_bytes = ((cur_bytes - sw_acc_tbl_entry->byte_count_last_polled) &
+		       FLOW_CNTR_BYTES_MAX(dparms));
+
+	atomic64_add(delta_bytes, &sw_acc_tbl_entry->byte_count);
+	atomic64_add(delta_pkts, &sw_acc_tbl_entry->pkt_count);
+
+	/* Update the last polled */
+	sw_acc_tbl_entry->pkt_count_last_polled = clear_on_read ? 0 : cur_pkts;
+	sw_acc_tbl_entry->byte_count_last_polled = clear_on_read ? 0 : cur_bytes;
+}
+
 int
 ulp_get_single_flow_stat(struct bnxt_ulp_context *ctxt,
 			 struct tf *tfp,
@@ -78,10 +107,6 @@ ulp_get_single_flow_stat(struct bnxt_ulp_context *ctxt,
 	struct bnxt *bp = tfp->bp;
 	u32 sw_cntr_indx = 0;
 	u64 stats = 0;
-	u64 delta_pkts = 0;
-	u64 delta_bytes = 0;
-	u64 cur_pkts = 0;
-	u64 cur_bytes = 0;
 	int rc = 0;
 
 	parms.dir = dir;
@@ -108,35 +133,153 @@ ulp_get_single_flow_stat(struct bnxt_ulp_context *ctxt,
 	 * the PMD need not do the accumulation itself and viceversa to report
 	 * the correct flow counters.
 	 */
-
-	cur_pkts = FLOW_CNTR_PKTS(stats, dparms);
-	cur_bytes = FLOW_CNTR_BYTES(stats, dparms);
-
-	delta_pkts = ((cur_pkts - sw_acc_tbl_entry->pkt_count_last_polled) &
-		      FLOW_CNTR_PKTS_MAX(dparms));
-	delta_bytes = ((cur_bytes - sw_acc_tbl_entry->byte_count_last_polled) &
-		       FLOW_CNTR_BYTES_MAX(dparms));
-
-	sw_acc_tbl_entry->pkt_count += delta_pkts;
-	sw_acc_tbl_entry->byte_count += delta_bytes;
+	ulp_fc_tf_accum_entry(sw_acc_tbl_entry, stats, false, dparms);
 
 	netdev_dbg(bp->dev,
-		   " STATS_64 dir %d for id:0x%x cc:%llu tot:%llu lp:%llu dp:0x%llx\n",
+		   " STATS_64 dir %d for id:0x%x cc:%llu tot:%lld\n",
 		   dir, parms.idx,
-		   cur_pkts,
-		   sw_acc_tbl_entry->pkt_count,
 		   sw_acc_tbl_entry->pkt_count_last_polled,
-		   delta_pkts);
+		   (s64)atomic64_read(&sw_acc_tbl_entry->pkt_count));
 
-	/* Update the last polled */
-	sw_acc_tbl_entry->pkt_count_last_polled = cur_pkts;
-	sw_acc_tbl_entry->byte_count_last_polled = cur_bytes;
+	return rc;
+}
 
+/* Read num_entries consecutive counters, starting at SW index start, into
+ * the shadow table with one DMA and accumulate the ones in use.
+ */
+static int
+ulp_fc_tf_bulk_flow_stat(struct tf *tfp, struct bnxt_ulp_fc_info *fc_info,
+			 enum tf_dir dir, u32 start, u32 num_entries,
+			 bool clear_on_read,
+			 struct bnxt_ulp_device_params *dparms)
+{
+	struct hw_fc_mem_info *shd_info = &fc_info->shadow_hw_tbl[dir];
+	struct tf_bulk_get_tbl_entry_parms parms = { 0 };
+	struct sw_acc_counter *sw_acc_tbl_entry;
+	u64 *stats;
+	u32 i;
+	int rc;
+
+	parms.dir = dir;
+	parms.type = TF_TBL_TYPE_ACT_STATS_64;
+	parms.starting_idx = shd_info->start_idx + start;
+	parms.num_entries = num_entries;
+	parms.entry_sz_in_bytes = sizeof(u64);
+	parms.physical_mem_addr = shd_info->mem_pa + start * sizeof(u64);
+	rc = tf_bulk_get_tbl_entry(tfp, &parms);
+	if (rc) {
+		netdev_dbg(tfp->bp->dev,
+			   "Bulk get failed for id:0x%x num:%u rc:%d\n",
+			   parms.starting_idx, num_entries, rc);
+		return rc;
+	}
+
+	stats = (u64 *)shd_info->mem_va + start;
+	sw_acc_tbl_entry = &fc_info->sw_acc_tbl[dir][start];
+	for (i = 0; i < num_entries; i++, stats++, sw_acc_tbl_entry++) {
+		if (!sw_acc_tbl_entry->valid)
+			continue;
+		ulp_fc_tf_accum_entry(sw_acc_tbl_entry, *stats, clear_on_read,
+				      dparms);
+	}
+	return 0;
+}
+
+/* Harvest all active counters, reading each run of counters that belong
+ * to the same session with a single bulk request.  Called with fc_lock
+ * held.
+ */
+static int
+ulp_fc_tf_update_accum_stats(struct bnxt_ulp_context *ctxt,
+			     struct bnxt_ulp_fc_info *fc_info,
+			     struct bnxt_ulp_device_params *dparms)
+{
+	u32 num_entries = dparms->flow_count_db_entries / 2;
+	enum bnxt_ulp_session_type session_type;
+	struct sw_acc_counter *sw_acc_tbl;
+	u32 dev_id, start, end, last, i;
+	bool clear_on_read;
+	enum tf_dir dir;
+	struct tf *tfp;
+	int rc = 0;
+
+	if (bnxt_ulp_cntxt_dev_id_get(ctxt, &dev_id))
+		return -EINVAL;
+
+	/* The stats are SRAM managed on Thor and a bulk read clears them.
+	 * Only ever read ranges made entirely of our own counters there.
+	 */
+	clear_on_read = (dev_id == BNXT_ULP_DEVICE_ID_THOR);
+
+	for (dir = 0; dir < TF_DIR_MAX; dir++) {
+		sw_acc_tbl = fc_info->sw_acc_tbl[dir];
+		for (start = 0; start < num_entries; start = end) {
+			if (!sw_acc_tbl[start].valid) {
+				end = start + 1;
+				continue;
+			}
+
+			session_type = sw_acc_tbl[start].session_type;
+			last = start;
+			for (end = start + 1; end < num_entries &&
+			     end - start < ULP_FC_TF_BULK_MAX_ENTRIES; end++) {
+				if (!sw_acc_tbl[end].valid) {
+					if (clear_on_read)
+						break;
+					continue;
+				}
+				if (sw_acc_tbl[end].session_type != session_type)
+					break;
+				last = end;
+			}
+			end = last + 1;
+
+			tfp = bnxt_tf_ulp_cntxt_tfp_get(ctxt, session_type);
+			if (!tfp) {
+				netdev_dbg(ctxt->bp->dev,
+					   "Failed to get the truflow pointer\n");
+				return -EINVAL;
+			}
+
+			if (fc_info->flags & ULP_FLAG_FC_BULK_EN) {
+				rc = ulp_fc_tf_bulk_flow_stat(tfp, fc_info, dir,
+							      start, end - start,
+							      clear_on_read,
+							      dparms);
+				if (!rc)
+					continue;
+				/* Firmware without the command, or one that
+				 * rejects the request, will not accept it on
+				 * a later pass either, so stick to single
+				 * reads.  Transient errors only fall back for
+				 * this pass.
+				 */
+				if (rc == -EOPNOTSUPP || rc == -EINVAL ||
+				    rc == -EACCES) {
+					netdev_info(ctxt->bp->dev,
+						    "Flow counter bulk read rejected, rc:%d, using single reads\n",
+						    rc);
+					fc_info->flags &= ~ULP_FLAG_FC_BULK_EN;
+				}
+			}
+
+			for (i = start; i < end; i++) {
+				if (!sw_acc_tbl[i].valid)
+					continue;
+				rc = ulp_get_single_flow_stat(ctxt, tfp, fc_info,
+							      dir,
+							      sw_acc_tbl[i].hw_cntr_id,
+							      dparms);
+				if (rc)
+					return rc;
+			}
+		}
+	}
 	return rc;
 }
 
 const struct bnxt_ulp_fc_core_ops ulp_fc_tf_core_ops = {
 		.ulp_flow_stat_get = ulp_tf_fc_tf_flow_stat_get,
-		.ulp_flow_stats_accum_update = NULL,
+		.ulp_flow_stats_accum_update = ulp_fc_tf_update_accum_stats,
 };
 #endif /* CONFIG_BNXT_FLOWER_OFFLOAD */
@@ -1375,13 +1375,7 @@ int bnxt_ulp_gen_flow_create(struct bnxt *bp,
 	/* Dump the flow action */
 	ulp_parser_act_info_dump(parser_params);
 
-	tf_rc =
-	    ulp_matcher_pattern_match(parser_params, &parser_params->class_id);
-	if (tf_rc != BNXT_TF_RC_SUCCESS)
-		goto free_fid;
-
-	tf_rc =
-	    ulp_matcher_action_match(parser_params, &parser_params->act_tmpl);
+	tf_rc = ulp_matcher_flow_match(parser_params);
 	if (tf_rc != BNXT_TF_RC_SUCCESS)
 		goto free_fid;
 
@@ -3,6 +3,8 @@
  * All rights reserved.
  */
 
+#include <linux/debugfs.h>
+#include <linux/ktime.h>
 #include "ulp_linux.h"
 #include "bnxt_compat.h"
 #include "bnxt_hsi.h"
@@ -15,6 +17,7 @@
 #include "tf_ext_flow_handle.h"
 #include "ulp_mark_mgr.h"
 #include "ulp_mapper.h"
+#include "ulp_matcher.h"
 #include "ulp_flow_db.h"
 #include "tf_util.h"
 #include "ulp_template_db_tbl.h"
@@ -24,6 +27,7 @@
 #include "bnxt_vfr.h"
 #include "bnxt_tf_tc_shim.h"
 #include "bnxt_tf_ulp_p5.h"
+#include "bnxt_debugfs.h"
 
 #if defined(CONFIG_BNXT_FLOWER_OFFLOAD) || defined(CONFIG_BNXT_CUSTOM_FLOWER_OFFLOAD)
 static u8 mapper_fld_zeros[16] = { 0 };
@@ -2084,6 +2088,59 @@ error:
 	return -EINVAL;
 }
 
+/* Return the compiled result program of the given table, or NULL if the
+ * table has to go through the field interpreter.
+ */
+static struct ulp_mapper_tbl_prog *
+ulp_mapper_tbl_prog_get(struct bnxt_ulp_mapper_parms *parms,
+			struct bnxt_ulp_mapper_tbl_info *tbl)
+{
+	struct bnxt_ulp_mapper_data *mdata = parms->mapper_data;
+	struct ulp_mapper_tmpl_prog *prog;
+	struct ulp_mapper_tbl_prog *tprog;
+
+	if (!mdata || !READ_ONCE(mdata->compiled_en))
+		return NULL;
+
+	prog = &mdata->tmpl_prog[parms->tmpl_type];
+	if (!prog->tbls || tbl < prog->tbl_list ||
+	    tbl >= prog->tbl_list + prog->num_tbls)
+		return NULL;
+
+	tprog = &prog->tbls[tbl - prog->tbl_list];
+	return tprog->num_ops ? tprog : NULL;
+}
+
+static int
+ulp_mapper_tbl_prog_run(struct bnxt_ulp_mapper_parms *parms,
+			struct bnxt_ulp_mapper_tbl_info *tbl,
+			struct ulp_mapper_tbl_prog *tprog,
+			struct ulp_blob *data,
+			const char *name)
+{
+	struct ulp_mapper_fld_op *op;
+	int rc = 0;
+	u16 i;
+
+	for (i = 0; i < tprog->num_ops && !rc; i++) {
+		op = &tprog->ops[i];
+		switch (op->op) {
+		case ULP_MAPPER_FLD_OP_PAD:
+			rc = ulp_blob_pad_push(data, op->bitlen);
+			break;
+		case ULP_MAPPER_FLD_OP_CONST:
+			rc = ulp_blob_push(data, op->val, op->bitlen);
+			break;
+		default:
+			rc = ulp_mapper_field_opc_process(parms, tbl->direction,
+							  op->fld, data, 0,
+							  name);
+			break;
+		}
+	}
+	return rc;
+}
+
 /**
  * Result table process and fill the result blob.
  * @data: - the result blob data
@@ -2097,6 +2154,7 @@ ulp_mapper_tbl_result_build(struct bnxt_ulp_mapper_parms *parms,
 	struct bnxt_ulp_mapper_field_info *dflds;
 	u32 i = 0, num_flds = 0, encap_flds = 0;
 	const struct ulp_mapper_core_ops *oper;
+	struct ulp_mapper_tbl_prog *tprog;
 	struct ulp_blob encap_blob;
 	int rc = 0;
 
@@ -2111,8 +2169,17 @@ ulp_mapper_tbl_result_build(struct bnxt_ulp_mapper_parms *parms,
 		return -EINVAL;
 	}
 
-	/* process the result fields */
-	for (i = 0; i < num_flds; i++) {
+	/* process the result fields, using the compiled program if any */
+	tprog = ulp_mapper_tbl_prog_get(parms, tbl);
+	if (tprog) {
+		rc = ulp_mapper_tbl_prog_run(parms, tbl, tprog, data, name);
+		if (rc) {
+			netdev_dbg(parms->ulp_ctx->bp->dev, "result field processing failed\n");
+			return rc;
+		}
+		i = num_flds;
+	}
+	for (; i < num_flds; i++) {
 		rc = ulp_mapper_field_opc_process(parms, tbl->direction,
 						  &dflds[i], data, 0, name);
 		if (rc) {
@@ -4333,6 +4400,28 @@ ulp_mapper_flow_destroy(struct bnxt_ulp_context *ulp_ctx,
 	return ulp_mapper_resources_free(ulp_ctx, flow_type, fid, error);
 }
 
+static void
+ulp_mapper_flow_stats_update(struct bnxt_ulp_mapper_data *mdata, u64 start_ns)
+{
+	struct ulp_mapper_flow_stats *stats;
+	u64 delta, max;
+
+	delta = ktime_get_ns() - start_ns;
+	stats = &mdata->flow_stats[READ_ONCE(mdata->compiled_en) ?
+				   ULP_MAPPER_EXEC_COMPILED :
+				   ULP_MAPPER_EXEC_INTERP];
+	atomic64_inc(&stats->flows);
+	atomic64_add(delta, &stats->total_ns);
+	max = atomic64_read(&stats->max_ns);
+	while (delta > max) {
+		u64 old = atomic64_cmpxchg(&stats->max_ns, max, delta);
+
+		if (old == max)
+			break;
+		max = old;
+	}
+}
+
 /* Function to handle the mapping of the Flow to be compatible
  * with the underlying hardware.
  */
@@ -4342,11 +4431,13 @@ ulp_mapper_flow_create(struct bnxt_ulp_context *ulp_ctx,
 {
 	struct ulp_regfile *regfile;
 	int	 rc = 0, trc;
+	u64 start_ns;
 
 	if (!ulp_ctx || !parms)
 		return -EINVAL;
 
-	regfile = vzalloc(sizeof(*regfile));
+	start_ns = ktime_get_ns();
+	regfile = kzalloc(sizeof(*regfile), GFP_KERNEL);
 	if (!regfile)
 		return -ENOMEM;
 
@@ -4409,7 +4500,8 @@ ulp_mapper_flow_create(struct bnxt_ulp_context *ulp_ctx,
 			goto flow_error;
 	}
 
-	vfree(parms->regfile);
+	ulp_mapper_flow_stats_update(parms->mapper_data, start_ns);
+	kfree(parms->regfile);
 	return rc;
 
 flow_error:
@@ -4433,10 +4525,244 @@ flow_error:
 	}
 
 err:
-	vfree(parms->regfile);
+	kfree(parms->regfile);
 	return rc;
 }
 
+/* Classify a single result field.  Fields whose value does not depend on
+ * the flow are folded into a pad or a constant push, everything else keeps
+ * running through ulp_mapper_field_opc_process().  Returns false if the
+ * field emits nothing.
+ */
+static bool
+ulp_mapper_fld_op_compile(struct bnxt_ulp_mapper_field_info *fld,
+			  struct ulp_mapper_fld_op *op)
+{
+	op->fld = fld;
+	op->bitlen = fld->field_bit_size;
+	op->val = NULL;
+	op->op = ULP_MAPPER_FLD_OP_GENERIC;
+
+	if (fld->field_opc == BNXT_ULP_FIELD_OPC_SKIP)
+		return false;
+	if (fld->field_opc != BNXT_ULP_FIELD_OPC_SRC1 || !op->bitlen ||
+	    op->bitlen > ULP_BYTE_2_BITS(sizeof(fld->field_opr1)))
+		return true;
+
+	switch (fld->field_src1) {
+	case BNXT_ULP_FIELD_SRC_SKIP:
+		return false;
+	case BNXT_ULP_FIELD_SRC_ZERO:
+		op->op = ULP_MAPPER_FLD_OP_PAD;
+		break;
+	case BNXT_ULP_FIELD_SRC_CONST:
+		op->op = ULP_MAPPER_FLD_OP_CONST;
+		op->val = fld->field_opr1;
+		break;
+	case BNXT_ULP_FIELD_SRC_ONES:
+		op->op = ULP_MAPPER_FLD_OP_CONST;
+		op->val = mapper_fld_ones;
+		break;
+	default:
+		break;
+	}
+	return true;
+}
+
+static void
+ulp_mapper_tmpl_prog_free(struct ulp_mapper_tmpl_prog *prog)
+{
+	vfree(prog->ops);
+	vfree(prog->tbls);
+	memset(prog, 0, sizeof(*prog));
+}
+
+/* Flatten the result field lists of all tables of a template type into a
+ * per table op list, merging adjacent pads.
+ */
+static int
+ulp_mapper_tmpl_compile(struct bnxt_ulp_device_params *dparms,
+			enum bnxt_ulp_template_type tmpl_type,
+			struct ulp_mapper_tmpl_prog *prog)
+{
+	const struct bnxt_ulp_template_device_tbls *dev_tbls;
+	struct bnxt_ulp_mapper_field_info *fld;
+	struct bnxt_ulp_mapper_tbl_info *tbl;
+	struct ulp_mapper_tbl_prog *tprog;
+	struct ulp_mapper_fld_op *op, *last;
+	u32 i, j, num_ops = 0;
+
+	dev_tbls = &dparms->dev_tbls[tmpl_type];
+	if (!dev_tbls->tbl_list || !dev_tbls->result_field_list)
+		return 0;
+
+	for (i = 0; i < dev_tbls->tbl_list_size; i++)
+		num_ops += dev_tbls->tbl_list[i].result_num_fields;
+	if (!num_ops)
+		return 0;
+
+	prog->tbls = vzalloc(dev_tbls->tbl_list_size * sizeof(*prog->tbls));
+	prog->ops = vzalloc(num_ops * sizeof(*prog->ops));
+	if (!prog->tbls || !prog->ops) {
+		ulp_mapper_tmpl_prog_free(prog);
+		return -ENOMEM;
+	}
+	prog->tbl_list = dev_tbls->tbl_list;
+	prog->num_tbls = dev_tbls->tbl_list_size;
+
+	op = prog->ops;
+	for (i = 0; i < prog->num_tbls; i++) {
+		tbl = &dev_tbls->tbl_list[i];
+		tprog = &prog->tbls[i];
+		tprog->ops = op;
+		if (tbl->result_start_idx + tbl->result_num_fields >
+		    dev_tbls->result_field_list_size)
+			continue;
+
+		fld = &dev_tbls->result_field_list[tbl->result_start_idx];
+		last = NULL;
+		for (j = 0; j < tbl->result_num_fields; j++, fld++) {
+			if (!ulp_mapper_fld_op_compile(fld, op))
+				continue;
+			if (last && last->op == ULP_MAPPER_FLD_OP_PAD &&
+			    op->op == ULP_MAPPER_FLD_OP_PAD &&
+			    last->bitlen + op->bitlen <= U16_MAX) {
+				last->bitlen += op->bitlen;
+				continue;
+			}
+			last = op++;
+			tprog->num_ops++;
+		}
+	}
+	return 0;
+}
+
+static int
+ulp_mapper_tmpl_prog_init(struct bnxt_ulp_context *ulp_ctx,
+			  struct bnxt_ulp_mapper_data *mdata)
+{
+	struct bnxt_ulp_device_params *dparms;
+	u32 dev_id, type;
+	int rc;
+
+	if (bnxt_ulp_cntxt_dev_id_get(ulp_ctx, &dev_id))
+		return -EINVAL;
+
+	dparms = bnxt_ulp_device_params_get(dev_id);
+	if (!dparms)
+		return -EINVAL;
+
+	for (type = 0; type < BNXT_ULP_TEMPLATE_TYPE_LAST; type++) {
+		rc = ulp_mapper_tmpl_compile(dparms, type,
+					     &mdata->tmpl_prog[type]);
+		if (rc)
+			return rc;
+	}
+	mdata->compiled_en = 1;
+	return 0;
+}
+
+static void
+ulp_mapper_tmpl_prog_deinit(struct bnxt_ulp_mapper_data *mdata)
+{
+	u32 type;
+
+	mdata->compiled_en = 0;
+	for (type = 0; type < BNXT_ULP_TEMPLATE_TYPE_LAST; type++)
+		ulp_mapper_tmpl_prog_free(&mdata->tmpl_prog[type]);
+}
+
+#ifdef CONFIG_DEBUG_FS
+static const char * const ulp_mapper_exec_mode_str[] = {
+	[ULP_MAPPER_EXEC_INTERP]	= "interpreted",
+	[ULP_MAPPER_EXEC_COMPILED]	= "compiled",
+};
+
+static ssize_t ulp_mapper_flow_stats_read(struct file *filep,
+					  char __user *buffer,
+					  size_t count, loff_t *ppos)
+{
+	struct bnxt_ulp_mapper_data *mdata = filep->private_data;
+	struct ulp_mapper_flow_stats *stats;
+	u64 flows, total_ns;
+	char buf[256];
+	int len = 0;
+	int i;
+
+	for (i = 0; i < ULP_MAPPER_EXEC_MAX; i++) {
+		stats = &mdata->flow_stats[i];
+		flows = atomic64_read(&stats->flows);
+		total_ns = atomic64_read(&stats->total_ns);
+		len += scnprintf(buf + len, sizeof(buf) - len,
+				 "%s: flows = %llu avg_ns = %llu max_ns = %llu\n",
+				 ulp_mapper_exec_mode_str[i], flows,
+				 flows ? div64_u64(total_ns, flows) : 0,
+				 (u64)atomic64_read(&stats->max_ns));
+	}
+
+	return simple_read_from_buffer(buffer, count, ppos, buf, len);
+}
+
+static ssize_t ulp_mapper_flow_stats_write(struct file *filep,
+					   const char __user *buffer,
+					   size_t count, loff_t *ppos)
+{
+	struct bnxt_ulp_mapper_data *mdata = filep->private_data;
+	int i;
+
+	for (i = 0; i < ULP_MAPPER_EXEC_MAX; i++) {
+		atomic64_set(&mdata->flow_stats[i].flows, 0);
+		atomic64_set(&mdata->flow_stats[i].total_ns, 0);
+		atomic64_set(&mdata->flow_stats[i].max_ns, 0);
+	}
+	return count;
+}
+
+static const struct file_operations ulp_mapper_flow_stats_fops = {
+	.owner	= THIS_MODULE,
+	.open	= simple_open,
+	.read	= ulp_mapper_flow_stats_read,
+	.write	= ulp_mapper_flow_stats_write,
+};
+
+/* <debugfs>/bnxt_en/truflow/mapper_<pci>/
+ *   compiled   - 1 to use the compiled result programs, 0 to interpret
+ *   flow_stats - CPU time spent in flow create per mode, write to clear
+ */
+static void
+ulp_mapper_debugfs_init(struct bnxt_ulp_context *ulp_ctx,
+			struct bnxt_ulp_mapper_data *mdata)
+{
+	mdata->debugfs_dir = bnxt_debug_tf_dev_dir_create(ulp_ctx->bp, "mapper");
+	if (IS_ERR_OR_NULL(mdata->debugfs_dir)) {
+		mdata->debugfs_dir = NULL;
+		return;
+	}
+	debugfs_create_u8("compiled", 0644, mdata->debugfs_dir,
+			  &mdata->compiled_en);
+	debugfs_create_file("flow_stats", 0644, mdata->debugfs_dir, mdata,
+			    &ulp_mapper_flow_stats_fops);
+}
+
+static void
+ulp_mapper_debugfs_deinit(struct bnxt_ulp_mapper_data *mdata)
+{
+	debugfs_remove_recursive(mdata->debugfs_dir);
+	mdata->debugfs_dir = NULL;
+}
+#else
+static void
+ulp_mapper_debugfs_init(struct bnxt_ulp_context *ulp_ctx,
+			struct bnxt_ulp_mapper_data *mdata)
+{
+}
+
+static void
+ulp_mapper_debugfs_deinit(struct bnxt_ulp_mapper_data *mdata)
+{
+}
+#endif
+
 int
 ulp_mapper_init(struct bnxt_ulp_context *ulp_ctx)
 {
@@ -4502,6 +4828,16 @@ ulp_mapper_init(struct bnxt_ulp_context *ulp_ctx)
 		goto error;
 	}
 
+	/* Failing to compile only costs performance, keep interpreting */
+	if (ulp_mapper_tmpl_prog_init(ulp_ctx, data)) {
+		netdev_dbg(ulp_ctx->bp->dev, "Failed to compile mapper templates\n");
+		ulp_mapper_tmpl_prog_deinit(data);
+	}
+	ulp_mapper_debugfs_init(ulp_ctx, data);
+
+	/* Cached match results refer to the templates just loaded */
+	ulp_matcher_flow_cache_flush(ulp_ctx);
+
 	return 0;
 error:
 	/* Ignore the return code in favor of returning the original error. */
@@ -4525,6 +4861,11 @@ ulp_mapper_deinit(struct bnxt_ulp_context *ulp_ctx)
 		return;
 	}
 
+	ulp_mapper_debugfs_deinit(data);
+
+	/* Free the compiled template programs */
+	ulp_mapper_tmpl_prog_deinit(data);
+
 	/* Free the global resource info table entries */
 	ulp_mapper_glb_resource_info_deinit(ulp_ctx, data);
 
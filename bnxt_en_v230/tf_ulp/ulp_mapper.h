@@ -40,6 +40,45 @@ struct bnxt_ulp_key_recipe_info {
 	struct bitalloc *recipe_ba[BNXT_ULP_DIRECTION_LAST][ULP_RECIPE_TYPE_MAX];
 };
 
+/* Opcodes of a compiled result field */
+enum ulp_mapper_fld_op_type {
+	ULP_MAPPER_FLD_OP_PAD,		/* advance the blob by bitlen bits */
+	ULP_MAPPER_FLD_OP_CONST,	/* push bitlen bits of val */
+	ULP_MAPPER_FLD_OP_GENERIC	/* run the field interpreter on fld */
+};
+
+struct ulp_mapper_fld_op {
+	u8					op;
+	u16					bitlen;
+	u8					*val;
+	struct bnxt_ulp_mapper_field_info	*fld;
+};
+
+/* Result fields of a single template table, flattened at init time */
+struct ulp_mapper_tbl_prog {
+	struct ulp_mapper_fld_op	*ops;
+	u16				num_ops;
+};
+
+struct ulp_mapper_tmpl_prog {
+	struct bnxt_ulp_mapper_tbl_info	*tbl_list;
+	u32				num_tbls;
+	struct ulp_mapper_tbl_prog	*tbls;
+	struct ulp_mapper_fld_op	*ops;
+};
+
+enum ulp_mapper_exec_mode {
+	ULP_MAPPER_EXEC_INTERP,
+	ULP_MAPPER_EXEC_COMPILED,
+	ULP_MAPPER_EXEC_MAX
+};
+
+struct ulp_mapper_flow_stats {
+	atomic64_t	flows;
+	atomic64_t	total_ns;
+	atomic64_t	max_ns;
+};
+
 struct ulp_mapper_core_ops;
 
 struct bnxt_ulp_mapper_data {
@@ -49,6 +88,10 @@ struct bnxt_ulp_mapper_data {
 	struct ulp_mapper_gen_tbl_list gen_tbl_list[BNXT_ULP_GEN_TBL_MAX_SZ];
 	struct bnxt_ulp_key_recipe_info key_recipe_info;
 	struct ulp_allocator_tbl_entry alloc_tbl[BNXT_ULP_ALLOCATOR_TBL_MAX_SZ];
+	struct ulp_mapper_tmpl_prog tmpl_prog[BNXT_ULP_TEMPLATE_TYPE_LAST];
+	u8 compiled_en;
+	struct ulp_mapper_flow_stats flow_stats[ULP_MAPPER_EXEC_MAX];
+	struct dentry *debugfs_dir;
 };
 
 /* Internal Structure for passing the arguments around */
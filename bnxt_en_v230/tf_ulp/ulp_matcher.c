@@ -7,7 +7,9 @@
 #include "ulp_matcher.h"
 #include "ulp_utils.h"
 #include "ulp_template_debug_proto.h"
+#include "bnxt_debugfs.h"
 #include <linux/vmalloc.h>
+#include <linux/debugfs.h>
 
 
 #if defined(CONFIG_BNXT_FLOWER_OFFLOAD) || defined(CONFIG_BNXT_CUSTOM_FLOWER_OFFLOAD)
@@ -157,6 +159,22 @@ ulp_matcher_class_hash_add(struct bnxt_ulp_matcher_data *matcher_data,
 	return matcher_node;
 }
 
+static void
+ulp_matcher_class_info_fill(struct ulp_tc_parser_params *params,
+			    u16 class_match_idx, u32 *class_id)
+{
+	struct bnxt_ulp_class_match_info *class_match;
+
+	class_match = &ulp_class_match_list[class_match_idx];
+	*class_id = class_match->class_tid;
+	params->class_info_idx = class_match_idx;
+	params->flow_sig_id =
+		ulp_matcher_class_hdr_field_signature(params, class_match_idx);
+	params->flow_pattern_id = class_match->flow_pattern_id;
+	params->wc_field_bitmap = ulp_matcher_class_wc_fld_get(class_match_idx);
+	params->exclude_field_bitmap = class_match->field_exclude_bitmap;
+}
+
 /* Function to handle the matching of RTE Flows and validating
  * the pattern masks against the flow templates.
  */
@@ -165,7 +183,6 @@ ulp_matcher_pattern_match(struct ulp_tc_parser_params *params,
 			  u32 *class_id)
 {
 	struct ulp_matcher_class_db_node *matcher_node;
-	struct bnxt_ulp_class_match_info *class_match;
 	struct bnxt_ulp_matcher_data *matcher_data;
 	u32 class_match_idx = 0;
 	u64 bits = 0;
@@ -198,25 +215,18 @@ ulp_matcher_pattern_match(struct ulp_tc_parser_params *params,
 		class_match_idx = matcher_node->match_info_idx;
 	}
 
-	class_match = &ulp_class_match_list[matcher_node->match_info_idx];
-
 	/* perform the field bitmap validation */
 	if (ulp_matcher_class_hdr_field_validate(params,
 						 matcher_node->match_info_idx))
 		goto error;
 
 	/* Update the fields for further processing */
-	*class_id = class_match->class_tid;
-	params->class_info_idx = matcher_node->match_info_idx;
-	params->flow_sig_id =
-		ulp_matcher_class_hdr_field_signature(params, class_match_idx);
-	params->flow_pattern_id = class_match->flow_pattern_id;
-	params->wc_field_bitmap = ulp_matcher_class_wc_fld_get(class_match_idx);
-	params->exclude_field_bitmap = class_match->field_exclude_bitmap;
+	ulp_matcher_class_info_fill(params, matcher_node->match_info_idx,
+				    class_id);
 
 	netdev_dbg(params->ulp_ctx->bp->dev,
 		   "Found matching pattern template %u:%d\n",
-		   class_match_idx, class_match->class_tid);
+		   class_match_idx, *class_id);
 	return BNXT_TF_RC_SUCCESS;
 
 error:
@@ -338,6 +348,213 @@ error:
 	return BNXT_TF_RC_ERROR;
 }
 
+static void
+ulp_matcher_flow_cache_key_get(struct ulp_tc_parser_params *params,
+			       struct ulp_matcher_flow_cache_key *key)
+{
+	memset(key, 0, sizeof(*key));
+	key->hdr_bits = params->hdr_bitmap.bits;
+	key->fld_s_bits = params->fld_s_bitmap.bits;
+	key->act_bits = params->act_bitmap.bits;
+	key->app_id = params->app_id;
+}
+
+static bool
+ulp_matcher_flow_cache_lookup(struct bnxt_ulp_matcher_data *mdata,
+			      struct ulp_matcher_flow_cache_key *key,
+			      struct ulp_matcher_flow_cache_node *res)
+{
+	struct ulp_matcher_flow_cache_node *node;
+
+	rcu_read_lock();
+	node = rhashtable_lookup_fast(&mdata->flow_cache, key,
+				      mdata->flow_cache_ht_params);
+	if (node) {
+		res->class_info_idx = node->class_info_idx;
+		res->act_info_idx = node->act_info_idx;
+		res->act_tmpl = node->act_tmpl;
+	}
+	rcu_read_unlock();
+	return !!node;
+}
+
+static void
+ulp_matcher_flow_cache_add(struct bnxt_ulp_matcher_data *mdata,
+			   struct ulp_matcher_flow_cache_key *key,
+			   struct ulp_tc_parser_params *params)
+{
+	struct ulp_matcher_flow_cache_node *node;
+
+	if (atomic_read(&mdata->flow_cache.nelems) >= ULP_MATCHER_FLOW_CACHE_MAX)
+		return;
+
+	node = kzalloc(sizeof(*node), GFP_KERNEL);
+	if (!node)
+		return;
+
+	node->key = *key;
+	node->class_info_idx = params->class_info_idx;
+	node->act_info_idx = params->act_info_idx;
+	node->act_tmpl = params->act_tmpl;
+
+	mutex_lock(&mdata->flow_cache_lock);
+	if (rhashtable_lookup_insert_fast(&mdata->flow_cache, &node->node,
+					  mdata->flow_cache_ht_params))
+		kfree(node);
+	mutex_unlock(&mdata->flow_cache_lock);
+}
+
+static void
+ulp_matcher_flow_cache_remove_all(struct bnxt_ulp_matcher_data *mdata)
+{
+	struct ulp_matcher_flow_cache_node *node;
+	struct rhashtable_iter iter;
+
+	mutex_lock(&mdata->flow_cache_lock);
+	rhashtable_walk_enter(&mdata->flow_cache, &iter);
+	rhashtable_walk_start(&iter);
+	while ((node = rhashtable_walk_next(&iter)) != NULL) {
+		if (IS_ERR(node))
+			continue;
+		if (!rhashtable_remove_fast(&mdata->flow_cache, &node->node,
+					    mdata->flow_cache_ht_params))
+			kfree_rcu(node, rcu);
+	}
+	rhashtable_walk_stop(&iter);
+	rhashtable_walk_exit(&iter);
+	mutex_unlock(&mdata->flow_cache_lock);
+}
+
+/* Drop all cached match results, must be called whenever the class or
+ * action templates the results were computed from change.
+ */
+void ulp_matcher_flow_cache_flush(struct bnxt_ulp_context *ulp_ctx)
+{
+	struct bnxt_ulp_matcher_data *mdata;
+
+	mdata = (struct bnxt_ulp_matcher_data *)
+		bnxt_ulp_cntxt_ptr2_matcher_data_get(ulp_ctx);
+	if (!mdata)
+		return;
+
+	ulp_matcher_flow_cache_remove_all(mdata);
+}
+
+/* Function to handle the class and action matching of a flow.  Flows
+ * with a match signature that was seen before skip the template lookup
+ * and the field validation.
+ */
+int
+ulp_matcher_flow_match(struct ulp_tc_parser_params *params)
+{
+	struct ulp_matcher_flow_cache_key key;
+	struct ulp_matcher_flow_cache_node res;
+	struct bnxt_ulp_matcher_data *mdata;
+	int rc;
+
+	mdata = (struct bnxt_ulp_matcher_data *)
+		bnxt_ulp_cntxt_ptr2_matcher_data_get(params->ulp_ctx);
+	if (!mdata) {
+		netdev_dbg(params->ulp_ctx->bp->dev,
+			   "Failed to get the ulp matcher data\n");
+		return -EINVAL;
+	}
+
+	params->hdr_bitmap.bits |=
+		bnxt_ulp_cntxt_ptr2_default_class_bits_get(params->ulp_ctx);
+	params->act_bitmap.bits |=
+		bnxt_ulp_cntxt_ptr2_default_act_bits_get(params->ulp_ctx);
+
+	ulp_matcher_flow_cache_key_get(params, &key);
+	if (ulp_matcher_flow_cache_lookup(mdata, &key, &res)) {
+		atomic64_inc(&mdata->flow_cache_hits);
+		ulp_matcher_class_info_fill(params, res.class_info_idx,
+					    &params->class_id);
+		params->act_info_idx = res.act_info_idx;
+		params->act_tmpl = res.act_tmpl;
+		return BNXT_TF_RC_SUCCESS;
+	}
+	atomic64_inc(&mdata->flow_cache_misses);
+
+	rc = ulp_matcher_pattern_match(params, &params->class_id);
+	if (rc != BNXT_TF_RC_SUCCESS)
+		return rc;
+
+	rc = ulp_matcher_action_match(params, &params->act_tmpl);
+	if (rc != BNXT_TF_RC_SUCCESS)
+		return rc;
+
+	ulp_matcher_flow_cache_add(mdata, &key, params);
+	return BNXT_TF_RC_SUCCESS;
+}
+
+#ifdef CONFIG_DEBUG_FS
+static ssize_t ulp_matcher_cache_stats_read(struct file *filep,
+					    char __user *buffer,
+					    size_t count, loff_t *ppos)
+{
+	struct bnxt_ulp_matcher_data *mdata = filep->private_data;
+	char buf[128];
+	int len;
+
+	len = scnprintf(buf, sizeof(buf),
+			"entries = %d\nhits = %llu\nmisses = %llu\n",
+			atomic_read(&mdata->flow_cache.nelems),
+			(u64)atomic64_read(&mdata->flow_cache_hits),
+			(u64)atomic64_read(&mdata->flow_cache_misses));
+
+	return simple_read_from_buffer(buffer, count, ppos, buf, len);
+}
+
+/* Any write flushes the cache and clears the counters */
+static ssize_t ulp_matcher_cache_stats_write(struct file *filep,
+					     const char __user *buffer,
+					     size_t count, loff_t *ppos)
+{
+	struct bnxt_ulp_matcher_data *mdata = filep->private_data;
+
+	ulp_matcher_flow_cache_remove_all(mdata);
+	atomic64_set(&mdata->flow_cache_hits, 0);
+	atomic64_set(&mdata->flow_cache_misses, 0);
+	return count;
+}
+
+static const struct file_operations ulp_matcher_cache_stats_fops = {
+	.owner	= THIS_MODULE,
+	.open	= simple_open,
+	.read	= ulp_matcher_cache_stats_read,
+	.write	= ulp_matcher_cache_stats_write,
+};
+
+static void ulp_matcher_debugfs_init(struct bnxt_ulp_context *ulp_ctx,
+				     struct bnxt_ulp_matcher_data *mdata)
+{
+	mdata->debugfs_dir = bnxt_debug_tf_dev_dir_create(ulp_ctx->bp,
+							  "matcher");
+	if (IS_ERR_OR_NULL(mdata->debugfs_dir)) {
+		mdata->debugfs_dir = NULL;
+		return;
+	}
+	debugfs_create_file("flow_cache", 0644, mdata->debugfs_dir, mdata,
+			    &ulp_matcher_cache_stats_fops);
+}
+
+static void ulp_matcher_debugfs_deinit(struct bnxt_ulp_matcher_data *mdata)
+{
+	debugfs_remove_recursive(mdata->debugfs_dir);
+	mdata->debugfs_dir = NULL;
+}
+#else
+static void ulp_matcher_debugfs_init(struct bnxt_ulp_context *ulp_ctx,
+				     struct bnxt_ulp_matcher_data *mdata)
+{
+}
+
+static void ulp_matcher_debugfs_deinit(struct bnxt_ulp_matcher_data *mdata)
+{
+}
+#endif
+
 static const struct rhashtable_params ulp_matcher_class_ht_params = {
 	.head_offset = offsetof(struct ulp_matcher_class_db_node, node),
 	.key_offset = offsetof(struct ulp_matcher_class_db_node, key),
@@ -352,6 +569,13 @@ static const struct rhashtable_params ulp_matcher_act_ht_params = {
 	.automatic_shrinking = true
 };
 
+static const struct rhashtable_params ulp_matcher_flow_cache_ht_params = {
+	.head_offset = offsetof(struct ulp_matcher_flow_cache_node, node),
+	.key_offset = offsetof(struct ulp_matcher_flow_cache_node, key),
+	.key_len = sizeof(struct ulp_matcher_flow_cache_key),
+	.automatic_shrinking = true
+};
+
 int ulp_matcher_init(struct bnxt_ulp_context *ulp_ctx)
 {
 	struct bnxt_ulp_matcher_data *data;
@@ -388,11 +612,25 @@ int ulp_matcher_init(struct bnxt_ulp_context *ulp_ctx)
 	if (rc) {
 		netdev_dbg(ulp_ctx->bp->dev,
 			   "Failed to create action matcher hash table\n");
-		goto clear_matcher_data;
+		goto destroy_class_db;
 	}
 
+	data->flow_cache_ht_params = ulp_matcher_flow_cache_ht_params;
+	rc = rhashtable_init(&data->flow_cache, &data->flow_cache_ht_params);
+	if (rc) {
+		netdev_dbg(ulp_ctx->bp->dev,
+			   "Failed to create matcher flow cache\n");
+		goto destroy_act_db;
+	}
+	mutex_init(&data->flow_cache_lock);
+	ulp_matcher_debugfs_init(ulp_ctx, data);
+
 	return 0;
 
+destroy_act_db:
+	rhashtable_destroy(&data->act_matcher_db);
+destroy_class_db:
+	rhashtable_destroy(&data->class_matcher_db);
 clear_matcher_data:
 	bnxt_ulp_cntxt_ptr2_matcher_data_set(ulp_ctx, NULL);
 free_matcher_data:
@@ -498,6 +736,10 @@ void ulp_matcher_deinit(struct bnxt_ulp_context *ulp_ctx)
 	if (!data)
 		return;
 
+	ulp_matcher_debugfs_deinit(data);
+	ulp_matcher_flow_cache_remove_all(data);
+	rhashtable_destroy(&data->flow_cache);
+	mutex_destroy(&data->flow_cache_lock);
 	ulp_matcher_class_hash_deinit(ulp_ctx);
 	ulp_matcher_act_hash_deinit(ulp_ctx);
 	rhashtable_destroy(&data->class_matcher_db);
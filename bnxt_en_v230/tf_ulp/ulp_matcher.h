@@ -35,12 +35,40 @@ struct ulp_matcher_act_db_node {
 	struct rcu_head                 rcu;
 };
 
+/* Full matcher input of a flow, the result of the class and action match
+ * depends on nothing else.
+ */
+struct ulp_matcher_flow_cache_key {
+	u64				hdr_bits;
+	u64				fld_s_bits;
+	u64				act_bits;
+	u8				app_id;
+};
+
+struct ulp_matcher_flow_cache_node {
+	struct ulp_matcher_flow_cache_key	key;
+	struct rhash_head		node;
+	u16				class_info_idx;
+	u16				act_info_idx;
+	u32				act_tmpl;
+	struct rcu_head			rcu;
+};
+
+#define ULP_MATCHER_FLOW_CACHE_MAX	1024
+
 struct bnxt_ulp_matcher_data {
 	/* hash table to store matcher class info */
 	struct rhashtable               class_matcher_db;
 	struct rhashtable_params        class_matcher_db_ht_params;
 	struct rhashtable               act_matcher_db;
 	struct rhashtable_params        act_matcher_db_ht_params;
+	/* results of previous class + action matches */
+	struct rhashtable               flow_cache;
+	struct rhashtable_params        flow_cache_ht_params;
+	struct mutex                    flow_cache_lock;
+	atomic64_t                      flow_cache_hits;
+	atomic64_t                      flow_cache_misses;
+	struct dentry                   *debugfs_dir;
 };
 
 #endif /* CONFIG_BNXT_FLOWER_OFFLOAD */
@@ -64,6 +92,14 @@ int
 ulp_matcher_action_match(struct ulp_tc_parser_params *params,
 			 u32 *act_id);
 
+/* Class and action match of a flow, served from the flow cache when a
+ * flow with the same match signature was seen before.
+ */
+int
+ulp_matcher_flow_match(struct ulp_tc_parser_params *params);
+
+void ulp_matcher_flow_cache_flush(struct bnxt_ulp_context *ulp_ctx);
+
 int ulp_matcher_init(struct bnxt_ulp_context *ulp_ctx);
 void ulp_matcher_deinit(struct bnxt_ulp_context *ulp_ctx);
 